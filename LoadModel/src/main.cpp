@@ -21,6 +21,9 @@ int main()
 									   true, 
 									   TF::ChannelOrder::RGB,
 									   TF::ShapeOrder::ChannelsHeightWidth);
+
+	// Reuse the input tensor buffers between images
+	image_loader.SetTensorPool(std::make_shared<TF::TensorPool>());
 	
 	// Load Labels
 	std::ifstream in("data/label_map.json");
@@ -55,7 +58,7 @@ int main()
 			{
 				for (const auto& [key, value] : results)
 				{
-					const std::vector<float> pred = value.get_data<float>();
+					const TF::TensorView<float> pred(value);
 					uint32_t max_index = static_cast<uint32_t>(std::distance(pred.begin(), std::max_element(pred.begin(), pred.end())));
 
 					category_name = label_map.value(std::to_string(max_index), "UNKNOWN");
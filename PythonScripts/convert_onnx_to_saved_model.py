@@ -44,6 +44,13 @@ def save_as_saved_model(keras_model, output_dir):
  
  
  
+def convert(onnx_path, output_dir):
+    keras_model = convert_onnx_to_keras(onnx_path)
+    print("Created Keras Model")
+
+    save_as_saved_model(keras_model, output_dir)
+
+
 def main():
     parser = argparse.ArgumentParser(description="Convert ONNX to TensorFlow SavedModel")
     parser.add_argument("onnx_model", help="Path to the ONNX model file")
@@ -51,10 +58,7 @@ def main():
 
     args = parser.parse_args()
 
-    keras_model = convert_onnx_to_keras(args.onnx_model)
-    print("Created Keras Model")
-     
-    save_as_saved_model(keras_model, args.output_dir)
+    convert(args.onnx_model, args.output_dir)
 
 
 if __name__ == "__main__":
@@ -0,0 +1,133 @@
+# tf_worker.py
+#
+# Long-lived worker serving model build/train/extract/convert commands, so TensorFlow is
+# imported once instead of once per operation.
+#
+# Protocol: one JSON object per line.
+#   Request:  {"id": 1, "command": "build", "args": {...}}
+#   Events:   {"id": 1, "event": "log", "line": "..."}
+#             {"id": 1, "event": "progress", "epoch": 1, "epochs": 10, "loss": 0.5, "samples_per_sec": 1000.0}
+#   Response: {"id": 1, "status": "ok"} or {"id": 1, "status": "error", "error": "..."}
+import json
+import os
+import sys
+import traceback
+from contextlib import redirect_stdout
+
+
+class ProtocolChannel:
+    def __init__(self, stream):
+        self.stream = stream
+
+    def send(self, message):
+        self.stream.write(json.dumps(message) + "\n")
+        self.stream.flush()
+
+
+class EventWriter:
+    """Forwards everything printed by a handler to the caller, one log event per line."""
+
+    def __init__(self, channel, request_id):
+        self.channel = channel
+        self.request_id = request_id
+        self.pending = ""
+
+    def write(self, text):
+        self.pending += text
+        while "\n" in self.pending:
+            line, self.pending = self.pending.split("\n", 1)
+            self.channel.send({"id": self.request_id, "event": "log", "line": line})
+        return len(text)
+
+    def flush(self):
+        if self.pending:
+            self.channel.send({"id": self.request_id, "event": "log", "line": self.pending})
+            self.pending = ""
+
+
+def handle_build(args, emit):
+    import build_model_from_json
+    build_model_from_json.main(args["model_path"], args["version"])
+
+
+def handle_train(args, emit):
+    import train_model_from_json
+    train_model_from_json.main(args["model_path"],
+                               args["input_version"],
+                               args["output_version"],
+                               args["train_config"],
+                               args["train_data"],
+                               on_progress=lambda progress: emit("progress", progress),
+                               cancel_path=args.get("cancel_path"))
+
+
+def handle_extract(args, emit):
+    import extract_model_info
+    extract_model_info.extract_model_info(args["model_path"])
+
+
+def handle_convert(args, emit):
+    # Imported on demand as the ONNX packages are only needed for conversion
+    import convert_onnx_to_saved_model
+    convert_onnx_to_saved_model.convert(args["onnx_path"], args["output_dir"])
+
+
+HANDLERS = {
+    "build": handle_build,
+    "train": handle_train,
+    "extract": handle_extract,
+    "convert": handle_convert,
+}
+
+
+def main():
+    # Keep the original stdout as the protocol channel, anything else written to it
+    # (including TensorFlow's native logging) is sent to stderr instead
+    channel = ProtocolChannel(os.fdopen(os.dup(sys.stdout.fileno()), "w"))
+    os.dup2(sys.stderr.fileno(), sys.stdout.fileno())
+    sys.stdout = sys.stderr
+
+    import tensorflow as tf
+
+    for line in sys.stdin:
+        line = line.strip()
+        if not line:
+            continue
+
+        try:
+            request = json.loads(line)
+        except json.JSONDecodeError as e:
+            channel.send({"id": None, "status": "error", "error": f"Invalid Request: {e}"})
+            continue
+
+        request_id = request.get("id")
+        command = request.get("command")
+        if command == "shutdown":
+            channel.send({"id": request_id, "status": "ok"})
+            break
+
+        handler = HANDLERS.get(command)
+        if handler is None:
+            channel.send({"id": request_id, "status": "error", "error": f"Unknown Command: {command}"})
+            continue
+
+        writer = EventWriter(channel, request_id)
+
+        def emit(event, payload):
+            channel.send({"id": request_id, "event": event, **payload})
+
+        try:
+            with redirect_stdout(writer):
+                handler(request.get("args", {}), emit)
+            writer.flush()
+            channel.send({"id": request_id, "status": "ok"})
+        except (Exception, SystemExit):
+            writer.flush()
+            channel.send({"id": request_id, "status": "error", "error": traceback.format_exc()})
+        finally:
+            # Drop the Keras graph state of the handled model so the worker does not grow
+            tf.keras.backend.clear_session()
+
+
+if __name__ == "__main__":
+    main()
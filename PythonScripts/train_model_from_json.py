@@ -1,8 +1,15 @@
 import os
 import json
+import shutil
 import sys
+import time
 import tensorflow as tf
 import numpy as np
+from model_info import extract_tensor_names
+from training_data import load_training_data, make_dataset, read_shard_index, split_shards
+
+# Written next to the checkpoint once complete, shared with the native trainer
+CHECKPOINT_STATE_FILENAME = "checkpoint_state.json"
 
 def tf_dtype_from_string(dtype_str):
     return {
@@ -26,20 +33,83 @@ def load_image_as_tensor(path, target_shape, dtype):
     img = tf.cast(img, dtype)
     return img
 
-def main(model_path, input_version, output_version, train_config_json, train_data_json):
-    # Load files --------------------------------------------------------------
-    layout = load_json(f"{model_path}/model_description.json")
-    train_config = load_json(train_config_json)
-    train_data = load_json(train_data_json)
+class TrainingProgressCallback(tf.keras.callbacks.Callback):
+    """Reports the loss and throughput of each epoch, and stops the training once the cancel file exists."""
 
+    def __init__(self, sample_count, on_progress=None, cancel_path=None):
+        super().__init__()
+        self.sample_count = sample_count
+        self.on_progress = on_progress
+        self.cancel_path = cancel_path
+        self.epoch_start = 0.0
 
-    # --- Load Keras model ----------------------------------------------------
-    input_model_path = f"{model_path}/Saved_{input_version}/"
-    model = tf.keras.models.load_model(input_model_path)
-    # -------------------------------------------------------------------------
+    def cancelled(self):
+        return self.cancel_path is not None and os.path.exists(self.cancel_path)
 
+    def on_epoch_begin(self, epoch, logs=None):
+        self.epoch_start = time.perf_counter()
+
+    def on_train_batch_end(self, batch, logs=None):
+        if self.cancelled():
+            self.model.stop_training = True
+
+    def on_epoch_end(self, epoch, logs=None):
+        if self.on_progress is None:
+            return
+
+        elapsed = time.perf_counter() - self.epoch_start
+        self.on_progress({
+            "epoch": epoch + 1,
+            "epochs": self.params.get("epochs", 0),
+            "loss": float((logs or {}).get("loss", 0.0)),
+            "val_loss": float((logs or {}).get("val_loss", 0.0)),
+            "samples_per_sec": self.sample_count / elapsed if elapsed > 0 else 0.0
+        })
+
+def print_progress(progress):
+    """Prints the progress of an epoch as a JSON line, read by the C++ side while the script runs."""
+    print(json.dumps({"event": "progress", **progress}), flush=True)
+
+class CheckpointCallback(tf.keras.callbacks.Callback):
+    """Saves the weights and optimizer state every few epochs, so an interrupted training can resume."""
+
+    def __init__(self, manager, checkpoint_path, input_version, interval):
+        super().__init__()
+        self.manager = manager
+        self.checkpoint_path = checkpoint_path
+        self.input_version = input_version
+        self.interval = interval
+
+    def on_epoch_end(self, epoch, logs=None):
+        if (epoch + 1) % self.interval != 0:
+            return
+
+        # Invalidate the previous checkpoint while it is overwritten
+        state_path = f"{self.checkpoint_path}/{CHECKPOINT_STATE_FILENAME}"
+        if os.path.exists(state_path):
+            os.remove(state_path)
+
+        self.manager.save(checkpoint_number=epoch + 1)
+        with open(state_path, "w") as f:
+            json.dump({"input_version": self.input_version, "epoch": epoch + 1}, f, indent=4)
+
+def read_checkpoint_epoch(checkpoint_path, input_version):
+    """Returns the epoch of the checkpoint of the input version, 0 if there is none."""
+    state_path = f"{checkpoint_path}/{CHECKPOINT_STATE_FILENAME}"
+    if not os.path.exists(state_path):
+        return 0
+
+    try:
+        state = load_json(state_path)
+    except (OSError, ValueError):
+        return 0
+
+    return state.get("epoch", 0) if state.get("input_version") == input_version else 0
+
+def load_in_memory_data(layout, train_data_path):
+    """Loads the inputs and labels of a single JSON or binary training file as whole tensors."""
+    train_data = load_training_data(train_data_path)
 
-    # --- Prepare inputs and labels -------------------------------------------
     input_data = {}
     for input_spec in layout["inputs"]:
         name = input_spec["name"]
@@ -51,8 +121,9 @@ def main(model_path, input_version, output_version, train_config_json, train_dat
             print(f"Loading Image Inputs For '{name}'...")
 
             data_paths = train_data["inputs"][name]
+            # JSON files hold a list of paths per sample, binary files the loaded path
             img_tensors = [
-                load_image_as_tensor(path_list[0], shape[1:], dtype)
+                load_image_as_tensor(path_list[0] if isinstance(path_list, list) else path_list, shape[1:], dtype)
                 for path_list in data_paths
             ]
             tensor = tf.stack(img_tensors)
@@ -72,32 +143,142 @@ def main(model_path, input_version, output_version, train_config_json, train_dat
         raw_label = train_data["labels"][name]
         tensor = tf.convert_to_tensor(raw_label, dtype=tf.float32)
         label_data[name] = tensor
-    # -------------------------------------------------------------------------
 
+    return input_data, label_data
 
-    # --- Compile model -------------------------------------------------------
-    model.compile(optimizer='adam', loss='categorical_crossentropy')
+def make_sample_preparation(layout):
+    """Returns the function preparing each streamed sample like load_in_memory_data does for whole tensors."""
+    def prepare(inputs, labels):
+        input_data = {}
+        for input_spec in layout["inputs"]:
+            name = input_spec["name"]
+            dtype = tf_dtype_from_string(input_spec["dtype"])
+            shape = input_spec["shape"]
+
+            if input_spec.get("domain", "data") == "image":
+                input_data[name] = load_image_as_tensor(inputs[name], shape[1:], dtype)
+                continue
+
+            tensor = tf.cast(inputs[name], dtype)
+            target_shape = [dim for dim in shape if dim != -1]
+            if target_shape:
+                tensor = tf.reshape(tensor, target_shape)
+            input_data[name] = tensor
+
+        label_data = {output_spec["name"]: tf.cast(labels[output_spec["name"]], tf.float32) for output_spec in layout["outputs"]}
+        return input_data, label_data
+
+    return prepare
+
+def main(model_path, input_version, output_version, train_config_json, train_data_json, on_progress=None, cancel_path=None):
+    # Load files --------------------------------------------------------------
+    layout = load_json(f"{model_path}/model_description.json")
+    train_config = load_json(train_config_json)
+
+
+    # --- Load Keras model ----------------------------------------------------
+    input_model_path = f"{model_path}/Saved_{input_version}/"
+    model = tf.keras.models.load_model(input_model_path)
     # -------------------------------------------------------------------------
 
-    # --- Fit model -----------------------------------------------------------
+
+    # --- Compile model -------------------------------------------------------
     eps = train_config["epochs"]
     b_size = train_config["batch_size"]
     learning_rate = train_config["learning_rate"]
     shuffle = train_config["shuffle"]
     val_split = train_config["validation_split"]
 
-    model.fit(x=input_data, y=label_data, epochs=eps, batch_size=b_size)
+    optimizer = tf.keras.optimizers.get({
+        "class_name": train_config.get("optimizer", "adam"),
+        "config": {"learning_rate": learning_rate}
+    })
+    model.compile(optimizer=optimizer, loss=train_config.get("loss_function", "categorical_crossentropy"))
+    # -------------------------------------------------------------------------
+
+    # --- Resume from checkpoint ----------------------------------------------
+    checkpoint_path = f"{model_path}/train/checkpoint"
+    checkpoint = tf.train.Checkpoint(model=model, optimizer=optimizer)
+    manager = tf.train.CheckpointManager(checkpoint, checkpoint_path, max_to_keep=1)
+
+    initial_epoch = 0
+    if train_config.get("resume", True):
+        initial_epoch = read_checkpoint_epoch(checkpoint_path, int(input_version))
+        if initial_epoch > 0 and manager.latest_checkpoint:
+            checkpoint.restore(manager.latest_checkpoint)
+            print(f"Resuming Training From Epoch {initial_epoch}.")
+        else:
+            initial_epoch = 0
+    # -------------------------------------------------------------------------
+
+    # --- Prepare inputs and labels -------------------------------------------
+    if os.path.isdir(train_data_json):
+        # Sharded data is streamed, so the training memory does not grow with the data
+        train_ranges, validation_ranges = split_shards(read_shard_index(train_data_json), val_split)
+        prepare = make_sample_preparation(layout)
+
+        train_count = sum(end - begin for _, begin, end in train_ranges)
+        has_validation = len(validation_ranges) > 0
+        fit_data = {
+            "x": make_dataset(train_ranges, b_size, shuffle, prepare),
+            "validation_data": make_dataset(validation_ranges, b_size, False, prepare)
+        }
+    else:
+        input_data, label_data = load_in_memory_data(layout, train_data_json)
+
+        sample_count = int(next(iter(input_data.values())).shape[0]) if input_data else 0
+        train_count = sample_count - int(sample_count * val_split)
+        has_validation = val_split > 0
+        fit_data = {
+            "x": input_data,
+            "y": label_data,
+            "batch_size": b_size,
+            "shuffle": shuffle,
+            "validation_split": val_split
+        }
+    # -------------------------------------------------------------------------
+
+    # --- Fit model -----------------------------------------------------------
+    progress = TrainingProgressCallback(train_count, on_progress, cancel_path)
+
+    callbacks = [progress]
+    if train_config.get("early_stopping", False):
+        callbacks.append(tf.keras.callbacks.EarlyStopping(
+            monitor="val_loss" if has_validation else "loss",
+            patience=max(1, train_config.get("early_stopping_patience", 5)),
+            restore_best_weights=True))
+
+    checkpoint_interval = train_config.get("checkpoint_interval", 0)
+    if checkpoint_interval > 0:
+        callbacks.append(CheckpointCallback(manager, checkpoint_path, int(input_version), checkpoint_interval))
+
+    model.fit(**fit_data,
+              epochs=eps,
+              initial_epoch=min(initial_epoch, eps),
+              callbacks=callbacks)
+
+    # A cancelled training saves no version, its checkpoint is kept to resume from
+    if progress.cancelled():
+        raise RuntimeError("Training Cancelled.")
     # -------------------------------------------------------------------------
 
     # --- Save updated model --------------------------------------------------
     output_model_path = f"{model_path}/Saved_{output_version}/"
     model.save(output_model_path)
     print(f"Model Retrained and Saved to {output_model_path}")
+
+    # Extract Signatures, allowing the version to be published on its own
+    io = extract_tensor_names(output_model_path)
+    with open(f"{output_model_path}/cppflow_io_names.json", "w") as f:
+        json.dump(io, f, indent=2)
+
+    # The checkpoint is only needed until the trained version is saved
+    shutil.rmtree(checkpoint_path, ignore_errors=True)
     # -------------------------------------------------------------------------
 
 if __name__ == "__main__":
-    if len(sys.argv) != 6:
-        print("Usage: python train_model.py <model_path> <input_version> <output_version> <train_config.json> <train_data.json>")
+    if len(sys.argv) not in (6, 7):
+        print("Usage: python train_model.py <model_path> <input_version> <output_version> <train_config.json> <train_data dir|.bin|.json> [cancel_path]")
         sys.exit(-1)
 
     model_path = sys.argv[1]
@@ -105,9 +286,10 @@ if __name__ == "__main__":
     output_version = sys.argv[3]
     train_config_json = sys.argv[4]
     train_data_json = sys.argv[5]
+    cancel_path = sys.argv[6] if len(sys.argv) > 6 else None
 
     if (not os.path.exists(f"{model_path}/model_description.json")):
         print("Missing Model Description Json File.")
         sys.exit(-1)
 
-    main(model_path, input_version, output_version, train_config_json, train_data_json)
\ No newline at end of file
+    main(model_path, input_version, output_version, train_config_json, train_data_json, on_progress=print_progress, cancel_path=cancel_path)
\ No newline at end of file
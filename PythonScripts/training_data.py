@@ -0,0 +1,149 @@
+import json
+import os
+import struct
+import numpy as np
+import tensorflow as tf
+
+# Binary columnar training files written by TrainingBatch::WriteBinaryFile:
+#   "TFTB" | uint32 format version | uint64 header size | JSON header | aligned columns
+BINARY_MAGIC = b"TFTB"
+BINARY_VERSION = 1
+PREAMBLE_FORMAT = "<4sIQ"
+
+# Sharded training directories written by TrainingBatch::WriteBinaryShards hold binary training
+# files of consecutive samples, listed in sample order by their index
+SHARD_INDEX_FILENAME = "index.json"
+
+# Samples copied out of a mapped shard at a time
+READ_CHUNK_SAMPLES = 1024
+
+# Shards read concurrently, and samples shuffled across them, by the streaming pipeline
+INTERLEAVE_CYCLE_LENGTH = 4
+SHUFFLE_BUFFER_SAMPLES = 8192
+
+
+def read_header(path):
+    with open(path, "rb") as f:
+        magic, version, header_size = struct.unpack(PREAMBLE_FORMAT, f.read(struct.calcsize(PREAMBLE_FORMAT)))
+        if magic != BINARY_MAGIC:
+            raise ValueError(f"Not a binary training file: {path}")
+        if version != BINARY_VERSION:
+            raise ValueError(f"Unsupported binary training file version {version}: {path}")
+        return json.loads(f.read(header_size))
+
+
+def read_column(path, column):
+    """Maps a numeric column as a read-only array of shape [count] + shape, without copying,
+    or decodes a string column to a list of str."""
+    count = column["count"]
+    if column["dtype"] == "string":
+        offsets = np.memmap(path, dtype="<u8", mode="r", offset=column["offset"], shape=(count + 1,))
+        size = int(offsets[-1])
+        characters = np.memmap(path, dtype=np.uint8, mode="r", offset=column["offset"] + offsets.nbytes, shape=(size,)).tobytes() if size > 0 else b""
+        return [characters[offsets[i]:offsets[i + 1]].decode("utf-8") for i in range(count)]
+
+    shape = (count, *column["shape"])
+    if column["nbytes"] == 0:
+        return np.zeros(shape, dtype=column["dtype"])
+
+    return np.memmap(path, dtype=np.dtype(column["dtype"]).newbyteorder("<"), mode="r", offset=column["offset"], shape=shape)
+
+
+def read_training_data(path):
+    """Reads a binary training file as {"inputs": {name: column}, "labels": {name: column}},
+    the layout of the JSON training files."""
+    header = read_header(path)
+    return {
+        section: {column["name"]: read_column(path, column) for column in header[section]}
+        for section in ("inputs", "labels")
+    }
+
+
+def load_training_data(path):
+    """Reads a binary training file, or a JSON training file exported by SaveTrainingJson."""
+    if path.endswith(".json"):
+        with open(path, "r") as f:
+            return json.load(f)
+    return read_training_data(path)
+
+
+def read_shard_index(directory):
+    """Returns the (path, count) shards of a sharded training directory, in sample order."""
+    with open(os.path.join(directory, SHARD_INDEX_FILENAME), "r") as f:
+        index = json.load(f)
+    if index.get("version") != BINARY_VERSION:
+        raise ValueError(f"Unsupported sharded training data version {index.get('version')}: {directory}")
+    return [(os.path.join(directory, shard["path"]), shard["count"]) for shard in index["shards"]]
+
+
+def split_shards(shards, validation_split):
+    """Splits shards into training and validation (path, begin, end) sample ranges, the last
+    samples being held out for validation like the validation_split of Keras."""
+    total = sum(count for _, count in shards)
+    train_count = total - int(total * validation_split)
+
+    train_ranges, validation_ranges = [], []
+    start = 0
+    for path, count in shards:
+        split = min(max(train_count - start, 0), count)
+        if split > 0:
+            train_ranges.append((path, 0, split))
+        if split < count:
+            validation_ranges.append((path, split, count))
+        start += count
+    return train_ranges, validation_ranges
+
+
+def read_samples(path, begin, end):
+    """Yields ({input: values}, {label: values}) chunks of the samples of a shard range, only
+    copying the chunk being yielded out of the mapped file."""
+    data = read_training_data(path)
+    for start in range(begin, end, READ_CHUNK_SAMPLES):
+        stop = min(start + READ_CHUNK_SAMPLES, end)
+        yield tuple(
+            {name: np.array(column[start:stop], dtype=None if isinstance(column, np.ndarray) else object)
+             for name, column in data[section].items()}
+            for section in ("inputs", "labels")
+        )
+
+
+def make_dataset(ranges, batch_size, shuffle, prepare=None):
+    """Streams the samples of shard ranges as a batched tf.data pipeline. Shards are read in
+    parallel, interleaved and prefetched, so memory use is bounded by the shards being read
+    and the shuffle buffer rather than by the size of the training data.
+
+    prepare maps each (inputs, labels) sample, e.g. to load images, in parallel."""
+    if not ranges:
+        return None
+
+    # Every shard has the columns of the first
+    header = read_header(ranges[0][0])
+    signature = tuple(
+        {column["name"]: tf.TensorSpec(shape=(None, *column["shape"]),
+                                       dtype=tf.string if column["dtype"] == "string" else tf.as_dtype(column["dtype"]))
+         for column in header[section]}
+        for section in ("inputs", "labels")
+    )
+
+    def read_range(path, begin, end):
+        return tf.data.Dataset.from_generator(
+            lambda path, begin, end: read_samples(path.decode("utf-8"), int(begin), int(end)),
+            output_signature=signature,
+            args=(path, begin, end)
+        ).unbatch()
+
+    paths, begins, ends = zip(*ranges)
+    dataset = tf.data.Dataset.from_tensor_slices((list(paths), list(begins), list(ends)))
+    if shuffle:
+        dataset = dataset.shuffle(len(ranges), reshuffle_each_iteration=True)
+
+    dataset = dataset.interleave(read_range,
+                                 cycle_length=min(len(ranges), INTERLEAVE_CYCLE_LENGTH),
+                                 num_parallel_calls=tf.data.AUTOTUNE,
+                                 deterministic=not shuffle)
+    if shuffle:
+        dataset = dataset.shuffle(SHUFFLE_BUFFER_SAMPLES, reshuffle_each_iteration=True)
+    if prepare is not None:
+        dataset = dataset.map(prepare, num_parallel_calls=tf.data.AUTOTUNE)
+
+    return dataset.batch(batch_size).prefetch(tf.data.AUTOTUNE)
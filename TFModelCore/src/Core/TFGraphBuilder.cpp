@@ -0,0 +1,941 @@
+#include "Core/TFGraphBuilder.h"
+#include "Core/TFProtoUtils.h"
+#include "Core/TFTensorUtils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+namespace TF
+{
+	// tensorflow.SavedModel / MetaGraphDef / MetaInfoDef field numbers
+	static constexpr uint32_t SavedModelSchemaVersionField	= 1;
+	static constexpr uint32_t SavedModelMetaGraphsField		= 2;
+	static constexpr uint32_t MetaInfoDefField				= 1;
+	static constexpr uint32_t GraphDefField					= 2;
+	static constexpr uint32_t SaverDefField					= 3;
+	static constexpr uint32_t SignatureDefField				= 5;
+	static constexpr uint32_t MetaInfoTagsField				= 4;
+
+	// tensorflow.SaverDef field numbers
+	static constexpr uint32_t FilenameTensorNameField		= 1;
+	static constexpr uint32_t SaveTensorNameField			= 2;
+	static constexpr uint32_t RestoreOpNameField			= 3;
+	static constexpr uint32_t MaxToKeepField				= 4;
+	static constexpr uint32_t SaverVersionField				= 7;
+
+	// tensorflow.SignatureDef / TensorInfo / TensorShapeProto field numbers
+	static constexpr uint32_t MapKeyField					= 1;
+	static constexpr uint32_t MapValueField					= 2;
+	static constexpr uint32_t SignatureInputsField			= 1;
+	static constexpr uint32_t SignatureOutputsField			= 2;
+	static constexpr uint32_t SignatureMethodNameField		= 3;
+	static constexpr uint32_t TensorInfoNameField			= 1;
+	static constexpr uint32_t TensorInfoDTypeField			= 2;
+	static constexpr uint32_t TensorInfoShapeField			= 3;
+	static constexpr uint32_t ShapeDimField					= 2;
+	static constexpr uint32_t ShapeUnknownRankField			= 3;
+	static constexpr uint32_t DimSizeField					= 1;
+
+	// tensorflow.SaverDef.CheckpointFormatVersion.V2
+	static constexpr uint32_t SaverVersionV2 = 2;
+
+	// Names of the checkpoint operations referenced by the SaverDef
+	static constexpr const char* SaveFilenameName	= "save/Const";
+	static constexpr const char* SaveTensorName		= "save/control_dependency";
+	static constexpr const char* RestoreOpName		= "save/restore_all";
+
+	// Keras defaults of the built layers
+	static constexpr float BatchNormEpsilon		= 1e-3f;
+	static constexpr float BatchNormMomentum	= 0.99f;
+
+	using StatusPtr = std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)>;
+
+	static std::vector<int64_t> GetIntParams(const Layer& layer,
+											 const std::string& key,
+											 size_t count,
+											 int64_t default_value)
+	{
+		auto found = layer.mParameters.find(key);
+		if (found == layer.mParameters.end() || found->second.is_null())
+			return std::vector<int64_t>(count, default_value);
+
+		// Keras accepts either a single value for every dimension or one per dimension
+		if (found->second.is_array())
+			return found->second.get<std::vector<int64_t>>();
+
+		return std::vector<int64_t>(count, found->second.get<int64_t>());
+	}
+
+	static std::string GetPadding(const Layer& layer)
+	{
+		auto found = layer.mParameters.find("padding");
+		std::string padding = found != layer.mParameters.end() ? found->second.get<std::string>() : "valid";
+		std::transform(padding.begin(), padding.end(), padding.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+		return padding;
+	}
+
+	static nlohmann::json GetParam(const Layer& layer,
+								   const std::string& key)
+	{
+		auto found = layer.mParameters.find(key);
+		return found != layer.mParameters.end() ? found->second : nlohmann::json(nullptr);
+	}
+
+	static std::string SerializeTensorInfo(const std::string& name,
+										   TF_DataType dtype,
+										   const std::vector<int64_t>& shape,
+										   bool known_rank)
+	{
+		std::string tensor_shape;
+		if (known_rank)
+		{
+			for (int64_t dim : shape)
+			{
+				std::string dim_proto;
+				WriteVarintField(dim_proto, DimSizeField, static_cast<uint64_t>(dim));
+				WriteLengthDelimitedField(tensor_shape, ShapeDimField, dim_proto);
+			}
+		}
+		else
+		{
+			WriteVarintField(tensor_shape, ShapeUnknownRankField, 1);
+		}
+
+		std::string tensor_info;
+		WriteLengthDelimitedField(tensor_info, TensorInfoNameField, name);
+		WriteVarintField(tensor_info, TensorInfoDTypeField, static_cast<uint64_t>(dtype));
+		WriteLengthDelimitedField(tensor_info, TensorInfoShapeField, tensor_shape);
+		return tensor_info;
+	}
+
+	static std::string GetTensorName(TF_Output output)
+	{
+		return std::string(TF_OperationName(output.oper)) + ":" + std::to_string(output.index);
+	}
+
+	void GraphTrainingInfo::ReadFromFile(const std::filesystem::path& filepath)
+	{
+		std::ifstream ifs(filepath);
+		if (!ifs)
+			throw std::runtime_error("Failed to open File for Reading: " + filepath.string());
+
+		nlohmann::json j;
+		ifs >> j;
+		*this = from_json(j);
+	}
+
+	void GraphTrainingInfo::WriteToFile(const std::filesystem::path& filepath) const
+	{
+		std::ofstream ofs(filepath);
+		if (!ofs)
+			throw std::runtime_error("Failed to open File for Writing: " + filepath.string());
+
+		ofs << to_json().dump(4);
+	}
+
+	nlohmann::json GraphTrainingInfo::to_json() const
+	{
+		nlohmann::json result;
+
+		for (const GraphVariableInfo& variable : mVariables)
+		{
+			result["variables"].push_back(
+			{
+				{ "name", variable.mName },
+				{ "trainable", variable.mTrainable },
+				{ "value", variable.mValue },
+				{ "initial_value", variable.mInitialValue },
+				{ "initializer", variable.mInitializer }
+			});
+		}
+
+		result["update_ops"] = mUpdateOps;
+		result["training_flag"] = mTrainingFlag;
+		result["save_filename"] = mSaveFilename;
+		result["save_tensor"] = mSaveTensor;
+		return result;
+	}
+
+	GraphTrainingInfo GraphTrainingInfo::from_json(const nlohmann::json& inputJson)
+	{
+		GraphTrainingInfo info;
+
+		if (inputJson.contains("variables"))
+		{
+			for (const auto& variable : inputJson["variables"])
+			{
+				info.mVariables.push_back(
+				{
+					variable["name"].get<std::string>(),
+					variable["trainable"].get<bool>(),
+					variable["value"].get<std::string>(),
+					variable["initial_value"].get<std::string>(),
+					variable["initializer"].get<std::string>()
+				});
+			}
+		}
+
+		if (inputJson.contains("update_ops"))
+			info.mUpdateOps = inputJson["update_ops"].get<std::vector<std::string>>();
+		if (inputJson.contains("training_flag"))
+			info.mTrainingFlag = inputJson["training_flag"].get<std::string>();
+		if (inputJson.contains("save_filename"))
+			info.mSaveFilename = inputJson["save_filename"].get<std::string>();
+		if (inputJson.contains("save_tensor"))
+			info.mSaveTensor = inputJson["save_tensor"].get<std::string>();
+
+		return info;
+	}
+
+	GraphBuilder::GraphBuilder(uint64_t seed)
+		: GraphBuilder(std::shared_ptr<TF_Graph>(TF_NewGraph(), TF_DeleteGraph), seed)
+	{
+	}
+
+	GraphBuilder::GraphBuilder(std::shared_ptr<TF_Graph> graph,
+							   uint64_t seed)
+		: mpGraph(std::move(graph)),
+		mRandom(seed),
+		mSeed(seed)
+	{
+	}
+
+	bool GraphBuilder::Build(const ModelLayout& layout)
+	{
+		for (const Input& input : layout.mInputs)
+		{
+			const std::vector<int64_t> shape(input.mShape.begin(), input.mShape.end());
+			const TF_DataType dtype = ToTFDataType(input.mType);
+
+			const TF_Output placeholder = AddOp("Placeholder", input.mName, {}, [&](TF_OperationDescription* desc)
+			{
+				TF_SetAttrType(desc, "dtype", dtype);
+				TF_SetAttrShape(desc, "shape", shape.data(), static_cast<int>(shape.size()));
+			});
+
+			mTensors[input.mName] = placeholder;
+			mSignature.mInputs[input.mName] = input.mName + ":0";
+		}
+
+		for (const Layer& layer : layout.mLayers)
+		{
+			if (!mError.empty())
+				break;
+
+			const std::string scope = GetParam(layer, "output_name").get<std::string>();
+
+			TF_Output result = {};
+			if (layer.mType == LayerType::Add || layer.mType == LayerType::Multiply)
+			{
+				const std::vector<std::string> input_names = GetParam(layer, "input_names").get<std::vector<std::string>>();
+				for (size_t i = 0; i < input_names.size(); ++i)
+				{
+					TF_Output x;
+					if (!GetLayerInput(input_names[i], x))
+						break;
+
+					result = i == 0 ? x : AddOp(layer.mType == LayerType::Add ? "AddV2" : "Mul", scope + "/" + std::to_string(i), { result, x });
+				}
+			}
+			else
+			{
+				TF_Output x;
+				if (!GetLayerInput(GetParam(layer, "input_name").get<std::string>(), x))
+					break;
+
+				switch (layer.mType)
+				{
+				case LayerType::Dense:
+					result = AddDense(scope, x, layer);
+					break;
+				case LayerType::Flatten:
+					result = AddFlatten(scope, x);
+					break;
+				case LayerType::Activation:
+					result = AddActivation(scope, x, GetParam(layer, "activation"));
+					break;
+				case LayerType::Dropout:
+					result = AddDropout(scope, x, layer);
+					break;
+				case LayerType::Conv1D:
+					result = AddConvolution(scope, x, layer, true);
+					break;
+				case LayerType::Conv2D:
+					result = AddConvolution(scope, x, layer, false);
+					break;
+				case LayerType::MaxPooling2D:
+					result = AddMaxPooling(scope, x, layer);
+					break;
+				case LayerType::BatchNormalization:
+					result = AddBatchNormalization(scope, x, layer);
+					break;
+				default:
+					Fail("Unsupported Layer Type For Native Build");
+					break;
+				}
+			}
+
+			// The layer output is named after the layer so it can be fetched as "<output_name>:0"
+			mTensors[scope] = AddOp("Identity", scope, { result });
+		}
+
+		for (const Output& output : layout.mOutputs)
+		{
+			if (mTensors.find(output.mName) == mTensors.end())
+			{
+				Fail("Output '" + output.mName + "' is not produced by any layer.");
+				break;
+			}
+
+			mSignature.mOutputs[output.mName] = output.mName + ":0";
+		}
+
+		AddSaveOps();
+
+		if (!mError.empty())
+		{
+			std::cerr << "Failed Native Model Build {" << layout.mModelName << "}: " << mError << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	bool GraphBuilder::Save(const std::filesystem::path& export_dir) const
+	{
+		std::shared_ptr<Session> session = nullptr;
+		try
+		{
+			session = std::make_shared<Session>(mpGraph, std::unordered_map<std::string, SignatureDef>{});
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what() << std::endl;
+			return false;
+		}
+
+		if (!InitializeVariables(*session))
+			return false;
+
+		// Write the checkpoint where the SavedModel loader restores it from
+		std::filesystem::create_directories(export_dir / "variables");
+		const cppflow::tensor prefix = CreateStringTensor({ (export_dir / "variables" / "variables").string() }, {});
+		TF_Tensor* prefix_value = prefix.get_tensor().get();
+
+		const TF_Output prefix_input = { TF_GraphOperationByName(mpGraph.get(), SaveFilenameName), 0 };
+		const TF_Operation* save_op = TF_GraphOperationByName(mpGraph.get(), SaveTensorName);
+		if (!session->Run(&prefix_input, &prefix_value, 1, nullptr, nullptr, 0, &save_op, 1))
+		{
+			std::cerr << "Failed to Save Variables {" << export_dir << "}" << std::endl;
+			return false;
+		}
+
+		StatusPtr status(TF_NewStatus(), TF_DeleteStatus);
+
+		// Serialize the MetaGraphDef
+		std::unique_ptr<TF_Buffer, decltype(&TF_DeleteBuffer)> graph_def(TF_NewBuffer(), TF_DeleteBuffer);
+		TF_GraphToGraphDef(mpGraph.get(), graph_def.get(), status.get());
+		if (TF_GetCode(status.get()) != TF_OK)
+		{
+			std::cerr << "Failed to Serialize Graph: " << TF_Message(status.get()) << std::endl;
+			return false;
+		}
+
+		std::string meta_info_def;
+		WriteLengthDelimitedField(meta_info_def, MetaInfoTagsField, "serve");
+
+		std::string saver_def;
+		WriteLengthDelimitedField(saver_def, FilenameTensorNameField, std::string(SaveFilenameName) + ":0");
+		WriteLengthDelimitedField(saver_def, SaveTensorNameField, std::string(SaveTensorName) + ":0");
+		WriteLengthDelimitedField(saver_def, RestoreOpNameField, RestoreOpName);
+		WriteVarintField(saver_def, MaxToKeepField, 5);
+		WriteVarintField(saver_def, SaverVersionField, SaverVersionV2);
+
+		std::string signature_def;
+		for (const auto* tensors : { &mSignature.mInputs, &mSignature.mOutputs })
+		{
+			const uint32_t field = tensors == &mSignature.mInputs ? SignatureInputsField : SignatureOutputsField;
+			for (const auto& [key, name] : *tensors)
+			{
+				const TF_Output output = { TF_GraphOperationByName(mpGraph.get(), key.c_str()), 0 };
+				const std::vector<int64_t> shape = GetShape(output);
+				const bool known_rank = TF_GraphGetTensorNumDims(mpGraph.get(), output, status.get()) >= 0;
+
+				std::string entry;
+				WriteLengthDelimitedField(entry, MapKeyField, key);
+				WriteLengthDelimitedField(entry, MapValueField, SerializeTensorInfo(name, TF_OperationOutputType(output), shape, known_rank));
+				WriteLengthDelimitedField(signature_def, field, entry);
+			}
+		}
+		WriteLengthDelimitedField(signature_def, SignatureMethodNameField, "tensorflow/serving/predict");
+
+		std::string signature_entry;
+		WriteLengthDelimitedField(signature_entry, MapKeyField, "serving_default");
+		WriteLengthDelimitedField(signature_entry, MapValueField, signature_def);
+
+		std::string meta_graph_def;
+		WriteLengthDelimitedField(meta_graph_def, MetaInfoDefField, meta_info_def);
+		WriteLengthDelimitedField(meta_graph_def, GraphDefField, std::string_view(static_cast<const char*>(graph_def->data), graph_def->length));
+		WriteLengthDelimitedField(meta_graph_def, SaverDefField, saver_def);
+		WriteLengthDelimitedField(meta_graph_def, SignatureDefField, signature_entry);
+
+		std::string saved_model;
+		WriteVarintField(saved_model, SavedModelSchemaVersionField, 1);
+		WriteLengthDelimitedField(saved_model, SavedModelMetaGraphsField, meta_graph_def);
+
+		std::ofstream out(export_dir / "saved_model.pb", std::ios::binary);
+		if (!out.is_open())
+		{
+			std::cerr << "Failed to Write SavedModel {" << export_dir << "}" << std::endl;
+			return false;
+		}
+
+		out.write(saved_model.data(), saved_model.size());
+		if (!out.good())
+			return false;
+
+		GetTrainingInfo().WriteToFile(export_dir / GraphTrainingInfo::Filename);
+		return true;
+	}
+
+	bool GraphBuilder::InitializeVariables(const Session& session) const
+	{
+		std::vector<TF_Output> inputs;
+		std::vector<cppflow::tensor> values;
+		std::vector<TF_Tensor*> input_values;
+		std::vector<const TF_Operation*> initializers;
+		for (const GraphVariable& variable : mVariables)
+		{
+			const size_t length = variable.mInitialData.size() * sizeof(float);
+			TF_Tensor* tensor = TF_AllocateTensor(TF_FLOAT, variable.mShape.data(), static_cast<int>(variable.mShape.size()), length);
+			std::memcpy(TF_TensorData(tensor), variable.mInitialData.data(), length);
+
+			values.emplace_back(tensor);
+			inputs.push_back(variable.mInitialValue);
+			input_values.push_back(tensor);
+			initializers.push_back(variable.mInitializer);
+		}
+
+		if (!session.Run(inputs.data(), input_values.data(), static_cast<int>(inputs.size()),
+						 nullptr, nullptr, 0,
+						 initializers.data(), static_cast<int>(initializers.size())))
+		{
+			std::cerr << "Failed to Initialize Variables." << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	GraphTrainingInfo GraphBuilder::GetTrainingInfo() const
+	{
+		GraphTrainingInfo info;
+		for (const GraphVariable& variable : mVariables)
+		{
+			info.mVariables.push_back(
+			{
+				variable.mName,
+				variable.mTrainable,
+				GetTensorName(variable.mValue),
+				GetTensorName(variable.mInitialValue),
+				TF_OperationName(variable.mInitializer)
+			});
+		}
+
+		for (TF_Operation* op : mUpdateOps)
+			info.mUpdateOps.push_back(TF_OperationName(op));
+
+		if (mTrainingFlag.oper)
+			info.mTrainingFlag = GetTensorName(mTrainingFlag);
+
+		info.mSaveFilename = std::string(SaveFilenameName) + ":0";
+		info.mSaveTensor = std::string(SaveTensorName) + ":0";
+		return info;
+	}
+
+	TF_Output GraphBuilder::AddOp(const char* type,
+								  const std::string& name,
+								  const std::vector<TF_Output>& inputs,
+								  const std::function<void(TF_OperationDescription*)>& attributes)
+	{
+		if (!mError.empty())
+			return {};
+
+		for (const TF_Output& input : inputs)
+		{
+			if (!input.oper)
+				return Fail("Missing input for operation '" + name + "'.");
+		}
+
+		TF_OperationDescription* desc = TF_NewOperation(mpGraph.get(), type, name.c_str());
+		for (const TF_Output& input : inputs)
+			TF_AddInput(desc, input);
+
+		if (attributes)
+			attributes(desc);
+
+		StatusPtr status(TF_NewStatus(), TF_DeleteStatus);
+		TF_Operation* op = TF_FinishOperation(desc, status.get());
+		if (TF_GetCode(status.get()) != TF_OK)
+			return Fail(std::string("Failed to add ") + type + " '" + name + "': " + TF_Message(status.get()));
+
+		return { op, 0 };
+	}
+
+	TF_Output GraphBuilder::AddConst(const std::string& name,
+									 const cppflow::tensor& tensor)
+	{
+		const std::shared_ptr<TF_Tensor> tf_tensor = tensor.get_tensor();
+		TF_Tensor* value = tf_tensor.get();
+
+		StatusPtr status(TF_NewStatus(), TF_DeleteStatus);
+		const TF_Output output = AddOp("Const", name, {}, [&](TF_OperationDescription* desc)
+		{
+			TF_SetAttrTensor(desc, "value", value, status.get());
+			TF_SetAttrType(desc, "dtype", TF_TensorType(value));
+		});
+
+		if (TF_GetCode(status.get()) != TF_OK)
+			return Fail("Invalid constant '" + name + "': " + TF_Message(status.get()));
+		return output;
+	}
+
+	TF_Output GraphBuilder::AddFloatConst(const std::string& name,
+										  float value)
+	{
+		TF_Tensor* tensor = TF_AllocateTensor(TF_FLOAT, nullptr, 0, sizeof(float));
+		std::memcpy(TF_TensorData(tensor), &value, sizeof(float));
+		return AddConst(name, cppflow::tensor(tensor));
+	}
+
+	TF_Output GraphBuilder::AddInt32Const(const std::string& name,
+										  const std::vector<int32_t>& values)
+	{
+		const int64_t dims[] = { static_cast<int64_t>(values.size()) };
+		TF_Tensor* tensor = TF_AllocateTensor(TF_INT32, dims, 1, values.size() * sizeof(int32_t));
+		std::memcpy(TF_TensorData(tensor), values.data(), values.size() * sizeof(int32_t));
+		return AddConst(name, cppflow::tensor(tensor));
+	}
+
+	TF_Output GraphBuilder::AddInt64Const(const std::string& name,
+										  const std::vector<int64_t>& values)
+	{
+		const int64_t dims[] = { static_cast<int64_t>(values.size()) };
+		TF_Tensor* tensor = TF_AllocateTensor(TF_INT64, dims, 1, values.size() * sizeof(int64_t));
+		std::memcpy(TF_TensorData(tensor), values.data(), values.size() * sizeof(int64_t));
+		return AddConst(name, cppflow::tensor(tensor));
+	}
+
+	TF_Output GraphBuilder::AddVariable(const std::string& name,
+										const std::vector<int64_t>& shape,
+										std::vector<float> initial_data,
+										bool trainable)
+	{
+		GraphVariable variable;
+		variable.mName = name;
+		variable.mShape = shape;
+		variable.mTrainable = trainable;
+		variable.mInitialData = std::move(initial_data);
+
+		variable.mHandle = AddOp("VarHandleOp", name, {}, [&](TF_OperationDescription* desc)
+		{
+			TF_SetAttrType(desc, "dtype", TF_FLOAT);
+			TF_SetAttrShape(desc, "shape", shape.data(), static_cast<int>(shape.size()));
+			TF_SetAttrString(desc, "shared_name", name.data(), name.size());
+		});
+
+		const auto set_dtype = [](TF_OperationDescription* desc) { TF_SetAttrType(desc, "dtype", TF_FLOAT); };
+
+		variable.mValue = AddOp("ReadVariableOp", name + "/Read/ReadVariableOp", { variable.mHandle }, set_dtype);
+
+		variable.mInitialValue = AddOp("Placeholder", name + "/Initializer/initial_value", {}, [&](TF_OperationDescription* desc)
+		{
+			TF_SetAttrType(desc, "dtype", TF_FLOAT);
+			TF_SetAttrShape(desc, "shape", shape.data(), static_cast<int>(shape.size()));
+		});
+
+		variable.mInitializer = AddOp("AssignVariableOp", name + "/Assign", { variable.mHandle, variable.mInitialValue }, set_dtype).oper;
+
+		const TF_Output value = variable.mValue;
+		mVariables.push_back(std::move(variable));
+		return value;
+	}
+
+	TF_Output GraphBuilder::GetTrainingFlag()
+	{
+		if (!mTrainingFlag.oper)
+		{
+			const TF_Output default_value = AddFloatConst("training/default", 0.0f);
+			mTrainingFlag = AddOp("PlaceholderWithDefault", "training", { default_value }, [](TF_OperationDescription* desc)
+			{
+				TF_SetAttrType(desc, "dtype", TF_FLOAT);
+				TF_SetAttrShape(desc, "shape", nullptr, 0);
+			});
+		}
+		return mTrainingFlag;
+	}
+
+	std::vector<int64_t> GraphBuilder::GetShape(TF_Output output) const
+	{
+		if (!output.oper)
+			return {};
+
+		StatusPtr status(TF_NewStatus(), TF_DeleteStatus);
+		const int num_dims = TF_GraphGetTensorNumDims(mpGraph.get(), output, status.get());
+		if (TF_GetCode(status.get()) != TF_OK || num_dims <= 0)
+			return {};
+
+		std::vector<int64_t> shape(num_dims);
+		TF_GraphGetTensorShape(mpGraph.get(), output, shape.data(), num_dims, status.get());
+		if (TF_GetCode(status.get()) != TF_OK)
+			return {};
+		return shape;
+	}
+
+	bool GraphBuilder::GetLayerInput(const std::string& name,
+									 TF_Output& output)
+	{
+		auto found = mTensors.find(name);
+		if (found == mTensors.end())
+		{
+			Fail("Layer input '" + name + "' is not defined by any input or previous layer.");
+			return false;
+		}
+
+		output = found->second;
+		if (output.oper && TF_OperationOutputType(output) != TF_FLOAT)
+		{
+			output = AddOp("Cast", name + "/Cast", { output }, [](TF_OperationDescription* desc)
+			{
+				TF_SetAttrType(desc, "DstT", TF_FLOAT);
+			});
+			found->second = output;
+		}
+		return output.oper != nullptr;
+	}
+
+	TF_Output GraphBuilder::AddActivation(const std::string& scope,
+										  TF_Output x,
+										  const nlohmann::json& activation)
+	{
+		if (activation.is_null())
+			return x;
+
+		const std::string name = activation.get<std::string>();
+		if (name == "linear")
+			return x;
+		if (name == "relu")
+			return AddOp("Relu", scope + "/Relu", { x });
+		if (name == "sigmoid")
+			return AddOp("Sigmoid", scope + "/Sigmoid", { x });
+		if (name == "tanh")
+			return AddOp("Tanh", scope + "/Tanh", { x });
+		if (name == "softmax")
+			return AddOp("Softmax", scope + "/Softmax", { x });
+		if (name == "elu")
+			return AddOp("Elu", scope + "/Elu", { x });
+		if (name == "softplus")
+			return AddOp("Softplus", scope + "/Softplus", { x });
+		if (name == "swish" || name == "silu")
+			return AddOp("Mul", scope + "/Swish", { x, AddOp("Sigmoid", scope + "/Sigmoid", { x }) });
+
+		return Fail("Unsupported activation '" + name + "' in layer '" + scope + "'.");
+	}
+
+	TF_Output GraphBuilder::AddDense(const std::string& scope,
+									 TF_Output x,
+									 const Layer& layer)
+	{
+		const int64_t units = GetParam(layer, "units").get<int64_t>();
+
+		const std::vector<int64_t> shape = GetShape(x);
+		if (shape.empty() || shape.back() < 0)
+			return Fail("Dense layer '" + scope + "' requires a known input feature dimension.");
+
+		const int64_t features = shape.back();
+
+		// Like Keras, inputs of a higher rank are transformed along their last dimension
+		const bool reshape = shape.size() > 2;
+		if (reshape)
+		{
+			if (std::any_of(shape.begin() + 1, shape.end(), [](int64_t dim) { return dim < 0; }))
+				return Fail("Dense layer '" + scope + "' requires known non-batch input dimensions.");
+
+			x = AddOp("Reshape", scope + "/Reshape", { x, AddInt64Const(scope + "/Reshape/shape", { -1, features }) });
+		}
+
+		const TF_Output kernel = AddVariable(scope + "/kernel", { features, units }, GlorotUniform(features, units, static_cast<size_t>(features * units)));
+		const TF_Output bias = AddVariable(scope + "/bias", { units }, std::vector<float>(static_cast<size_t>(units), 0.0f));
+
+		TF_Output y = AddOp("MatMul", scope + "/MatMul", { x, kernel });
+		y = AddOp("BiasAdd", scope + "/BiasAdd", { y, bias });
+
+		if (reshape)
+		{
+			std::vector<int64_t> output_shape(shape.begin(), shape.end());
+			output_shape.front() = -1;
+			output_shape.back() = units;
+			y = AddOp("Reshape", scope + "/Reshape_1", { y, AddInt64Const(scope + "/Reshape_1/shape", output_shape) });
+		}
+
+		return AddActivation(scope, y, GetParam(layer, "activation"));
+	}
+
+	TF_Output GraphBuilder::AddConvolution(const std::string& scope,
+										   TF_Output x,
+										   const Layer& layer,
+										   bool one_dimensional)
+	{
+		const int64_t filters = GetParam(layer, "filters").get<int64_t>();
+		const std::string padding = GetPadding(layer);
+
+		const size_t spatial_dims = one_dimensional ? 1 : 2;
+		std::vector<int64_t> kernel_size = GetIntParams(layer, "kernel_size", spatial_dims, 1);
+		std::vector<int64_t> strides = GetIntParams(layer, "strides", spatial_dims, 1);
+		if (kernel_size.size() != spatial_dims || strides.size() != spatial_dims)
+			return Fail("Invalid kernel size or strides in layer '" + scope + "'.");
+
+		// 1D convolutions run as 2D convolutions over a unit height
+		if (one_dimensional)
+		{
+			x = AddOp("ExpandDims", scope + "/ExpandDims", { x, AddInt32Const(scope + "/ExpandDims/dim", { 1 }) });
+			kernel_size.insert(kernel_size.begin(), 1);
+			strides.insert(strides.begin(), 1);
+		}
+
+		const std::vector<int64_t> shape = GetShape(x);
+		if (shape.size() != 4 || shape.back() < 0)
+			return Fail("Convolution layer '" + scope + "' requires an input with known channels.");
+
+		const int64_t channels = shape.back();
+		const int64_t receptive_field = kernel_size[0] * kernel_size[1];
+
+		const std::vector<int64_t> kernel_shape = { kernel_size[0], kernel_size[1], channels, filters };
+		const TF_Output kernel = AddVariable(scope + "/kernel", kernel_shape, GlorotUniform(receptive_field * channels, receptive_field * filters, static_cast<size_t>(receptive_field * channels * filters)));
+		const TF_Output bias = AddVariable(scope + "/bias", { filters }, std::vector<float>(static_cast<size_t>(filters), 0.0f));
+
+		const int64_t conv_strides[] = { 1, strides[0], strides[1], 1 };
+		TF_Output y = AddOp("Conv2D", scope + "/Conv2D", { x, kernel }, [&](TF_OperationDescription* desc)
+		{
+			TF_SetAttrIntList(desc, "strides", conv_strides, 4);
+			TF_SetAttrString(desc, "padding", padding.data(), padding.size());
+		});
+
+		if (one_dimensional)
+		{
+			const int64_t squeeze_dims[] = { 1 };
+			y = AddOp("Squeeze", scope + "/Squeeze", { y }, [&](TF_OperationDescription* desc)
+			{
+				TF_SetAttrIntList(desc, "squeeze_dims", squeeze_dims, 1);
+			});
+		}
+
+		y = AddOp("BiasAdd", scope + "/BiasAdd", { y, bias });
+		return AddActivation(scope, y, GetParam(layer, "activation"));
+	}
+
+	TF_Output GraphBuilder::AddMaxPooling(const std::string& scope,
+										  TF_Output x,
+										  const Layer& layer)
+	{
+		const std::vector<int64_t> pool_size = GetIntParams(layer, "pool_size", 2, 2);
+		const std::vector<int64_t> strides = GetIntParams(layer, "strides", 2, 2);
+		if (pool_size.size() != 2 || strides.size() != 2)
+			return Fail("Invalid pool size or strides in layer '" + scope + "'.");
+
+		const std::string padding = GetPadding(layer);
+		const int64_t ksize[] = { 1, pool_size[0], pool_size[1], 1 };
+		const int64_t pool_strides[] = { 1, strides[0], strides[1], 1 };
+
+		return AddOp("MaxPool", scope + "/MaxPool", { x }, [&](TF_OperationDescription* desc)
+		{
+			TF_SetAttrIntList(desc, "ksize", ksize, 4);
+			TF_SetAttrIntList(desc, "strides", pool_strides, 4);
+			TF_SetAttrString(desc, "padding", padding.data(), padding.size());
+		});
+	}
+
+	TF_Output GraphBuilder::AddFlatten(const std::string& scope,
+									   TF_Output x)
+	{
+		const std::vector<int64_t> shape = GetShape(x);
+		if (shape.empty() || std::any_of(shape.begin() + 1, shape.end(), [](int64_t dim) { return dim < 0; }))
+			return Fail("Flatten layer '" + scope + "' requires known non-batch input dimensions.");
+
+		const int64_t features = std::accumulate(shape.begin() + 1, shape.end(), int64_t(1), std::multiplies<int64_t>());
+		return AddOp("Reshape", scope + "/Reshape", { x, AddInt64Const(scope + "/Reshape/shape", { -1, features }) });
+	}
+
+	TF_Output GraphBuilder::AddDropout(const std::string& scope,
+									   TF_Output x,
+									   const Layer& layer)
+	{
+		const float rate = GetParam(layer, "rate").get<float>();
+
+		// keep = 1 - rate * training, so inference keeps every unit without scaling
+		const TF_Output drop = AddOp("Mul", scope + "/rate", { AddFloatConst(scope + "/rate/value", rate), GetTrainingFlag() });
+		const TF_Output keep = AddOp("Sub", scope + "/keep", { AddFloatConst(scope + "/keep/one", 1.0f), drop });
+
+		const TF_Output shape = AddOp("Shape", scope + "/Shape", { x });
+		const TF_Output uniform = AddOp("RandomUniform", scope + "/RandomUniform", { shape }, [&](TF_OperationDescription* desc)
+		{
+			TF_SetAttrType(desc, "dtype", TF_FLOAT);
+			TF_SetAttrInt(desc, "seed", static_cast<int64_t>(mSeed & 0x7FFFFFFF));
+			TF_SetAttrInt(desc, "seed2", static_cast<int64_t>(mVariables.size() + mTensors.size()));
+		});
+
+		// The mask is constant with respect to the weights, and Floor has no registered gradient
+		const TF_Output mask = AddOp("StopGradient", scope + "/mask", { AddOp("Floor", scope + "/Floor", { AddOp("AddV2", scope + "/add", { uniform, keep }) }) });
+		const TF_Output scaled = AddOp("RealDiv", scope + "/truediv", { x, keep });
+		return AddOp("Mul", scope + "/mul", { scaled, mask });
+	}
+
+	TF_Output GraphBuilder::AddBatchNormalization(const std::string& scope,
+												  TF_Output x,
+												  const Layer& layer)
+	{
+		const std::vector<int64_t> shape = GetShape(x);
+		if (shape.size() < 2 || shape.back() < 0)
+			return Fail("BatchNormalization layer '" + scope + "' requires an input with known channels.");
+
+		const int64_t channels = shape.back();
+		const float epsilon = GetParam(layer, "epsilon").is_null() ? BatchNormEpsilon : GetParam(layer, "epsilon").get<float>();
+		const float momentum = GetParam(layer, "momentum").is_null() ? BatchNormMomentum : GetParam(layer, "momentum").get<float>();
+
+		const TF_Output gamma = AddVariable(scope + "/gamma", { channels }, std::vector<float>(static_cast<size_t>(channels), 1.0f));
+		const TF_Output beta = AddVariable(scope + "/beta", { channels }, std::vector<float>(static_cast<size_t>(channels), 0.0f));
+		const TF_Output moving_mean = AddVariable(scope + "/moving_mean", { channels }, std::vector<float>(static_cast<size_t>(channels), 0.0f), false);
+		const size_t moving_mean_index = mVariables.size() - 1;
+		const TF_Output moving_variance = AddVariable(scope + "/moving_variance", { channels }, std::vector<float>(static_cast<size_t>(channels), 1.0f), false);
+		const size_t moving_variance_index = mVariables.size() - 1;
+
+		// Batch statistics over every axis but the channels
+		std::vector<int32_t> axes(shape.size() - 1);
+		std::iota(axes.begin(), axes.end(), 0);
+		const TF_Output reduction_axes = AddInt32Const(scope + "/moments/axes", axes);
+
+		const TF_Output batch_mean = AddOp("Mean", scope + "/moments/mean", { x, reduction_axes });
+		const TF_Output centered = AddOp("Sub", scope + "/moments/sub", { x, batch_mean });
+		const TF_Output batch_variance = AddOp("Mean", scope + "/moments/variance", { AddOp("Square", scope + "/moments/Square", { centered }), reduction_axes });
+
+		// Blend towards the batch statistics while training: stat = moving + training * (batch - moving)
+		const TF_Output training = GetTrainingFlag();
+		const TF_Output mean = AddOp("AddV2", scope + "/mean", { moving_mean, AddOp("Mul", scope + "/mean/mul", { training, AddOp("Sub", scope + "/mean/sub", { batch_mean, moving_mean }) }) });
+		const TF_Output variance = AddOp("AddV2", scope + "/variance", { moving_variance, AddOp("Mul", scope + "/variance/mul", { training, AddOp("Sub", scope + "/variance/sub", { batch_variance, moving_variance }) }) });
+
+		const TF_Output inv_std = AddOp("Rsqrt", scope + "/Rsqrt", { AddOp("AddV2", scope + "/add", { variance, AddFloatConst(scope + "/epsilon", epsilon) }) });
+		const TF_Output normalized = AddOp("Mul", scope + "/mul", { AddOp("Sub", scope + "/sub", { x, mean }), AddOp("Mul", scope + "/scale", { inv_std, gamma }) });
+		const TF_Output y = AddOp("AddV2", scope + "/add_1", { normalized, beta });
+
+		// Moving statistics updates, run by each training step
+		const TF_Output decay = AddFloatConst(scope + "/momentum", momentum);
+		const TF_Output complement = AddFloatConst(scope + "/one_minus_momentum", 1.0f - momentum);
+		const auto set_dtype = [](TF_OperationDescription* desc) { TF_SetAttrType(desc, "dtype", TF_FLOAT); };
+
+		const std::pair<size_t, TF_Output> updates[] = { { moving_mean_index, batch_mean }, { moving_variance_index, batch_variance } };
+		for (const auto& [index, batch_value] : updates)
+		{
+			const GraphVariable& variable = mVariables[index];
+			const TF_Output updated = AddOp("AddV2", variable.mName + "/update", { AddOp("Mul", variable.mName + "/decay", { variable.mValue, decay }), AddOp("Mul", variable.mName + "/increment", { batch_value, complement }) });
+
+			TF_Operation* assign = AddOp("AssignVariableOp", variable.mName + "/AssignUpdate", { variable.mHandle, updated }, set_dtype).oper;
+			if (assign)
+				mUpdateOps.push_back(assign);
+		}
+
+		return y;
+	}
+
+	void GraphBuilder::AddSaveOps()
+	{
+		std::vector<std::string> names;
+		std::vector<TF_Output> values;
+		for (const GraphVariable& variable : mVariables)
+		{
+			names.push_back(variable.mName);
+			values.push_back(variable.mValue);
+		}
+
+		const int64_t count = static_cast<int64_t>(names.size());
+		const TF_Output prefix = AddOp("Placeholder", SaveFilenameName, {}, [](TF_OperationDescription* desc)
+		{
+			TF_SetAttrType(desc, "dtype", TF_STRING);
+			TF_SetAttrShape(desc, "shape", nullptr, 0);
+		});
+		const TF_Output tensor_names = AddConst("save/tensor_names", CreateStringTensor(names, { count }));
+		const TF_Output shapes_and_slices = AddConst("save/shape_and_slices", CreateStringTensor(std::vector<std::string>(names.size()), { count }));
+
+		if (!mError.empty())
+			return;
+
+		// save/SaveV2 -> save/control_dependency, as referenced by the SaverDef
+		TF_OperationDescription* save_desc = TF_NewOperation(mpGraph.get(), "SaveV2", "save/SaveV2");
+		TF_AddInput(save_desc, prefix);
+		TF_AddInput(save_desc, tensor_names);
+		TF_AddInput(save_desc, shapes_and_slices);
+		TF_AddInputList(save_desc, values.data(), static_cast<int>(values.size()));
+
+		StatusPtr status(TF_NewStatus(), TF_DeleteStatus);
+		TF_Operation* save_op = TF_FinishOperation(save_desc, status.get());
+		if (TF_GetCode(status.get()) != TF_OK)
+		{
+			Fail(std::string("Failed to add SaveV2: ") + TF_Message(status.get()));
+			return;
+		}
+
+		AddOp("Identity", SaveTensorName, { prefix }, [&](TF_OperationDescription* desc)
+		{
+			TF_AddControlInput(desc, save_op);
+		});
+
+		// save/RestoreV2 -> assignments -> save/restore_all
+		const std::vector<TF_DataType> dtypes(names.size(), TF_FLOAT);
+		const TF_Output restore = AddOp("RestoreV2", "save/RestoreV2", { prefix, tensor_names, shapes_and_slices }, [&](TF_OperationDescription* desc)
+		{
+			TF_SetAttrTypeList(desc, "dtypes", dtypes.data(), static_cast<int>(dtypes.size()));
+		});
+
+		std::vector<TF_Operation*> assignments;
+		for (size_t i = 0; i < mVariables.size(); ++i)
+		{
+			const TF_Output restored = { restore.oper, static_cast<int>(i) };
+			const TF_Output assign = AddOp("AssignVariableOp", "save/Assign_" + std::to_string(i), { mVariables[i].mHandle, restored }, [](TF_OperationDescription* desc)
+			{
+				TF_SetAttrType(desc, "dtype", TF_FLOAT);
+			});
+			assignments.push_back(assign.oper);
+		}
+
+		AddOp("NoOp", RestoreOpName, {}, [&](TF_OperationDescription* desc)
+		{
+			for (TF_Operation* assignment : assignments)
+			{
+				if (assignment)
+					TF_AddControlInput(desc, assignment);
+			}
+		});
+	}
+
+	std::vector<float> GraphBuilder::GlorotUniform(int64_t fan_in,
+												   int64_t fan_out,
+												   size_t count)
+	{
+		const float limit = std::sqrt(6.0f / static_cast<float>(std::max<int64_t>(1, fan_in + fan_out)));
+		std::uniform_real_distribution<float> distribution(-limit, limit);
+
+		std::vector<float> values(count);
+		for (float& value : values)
+			value = distribution(mRandom);
+		return values;
+	}
+
+	TF_Output GraphBuilder::Fail(const std::string& message)
+	{
+		if (mError.empty())
+			mError = message;
+		return {};
+	}
+}
@@ -0,0 +1,312 @@
+#pragma once
+
+#include "CppFlowLib.h"
+#include "Core/TFModelLayout.h"
+#include "Core/TFSession.h"
+#include "Core/TFSignatureDef.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TF
+{
+	/// <summary>
+	/// Struct representing a resource variable of a natively built graph.
+	/// </summary>
+	struct GraphVariable
+	{
+	public:
+		// Name of the variable, also used as its checkpoint key
+		std::string mName;
+
+		std::vector<int64_t> mShape;
+
+		// Whether the variable is updated by the optimizer, rather than by its update op
+		bool mTrainable = true;
+
+		TF_Output mHandle = {};
+		TF_Output mValue = {};
+
+		// Placeholder and assignment used to set the initial value
+		TF_Output mInitialValue = {};
+		TF_Operation* mInitializer = nullptr;
+
+		std::vector<float> mInitialData;
+	};
+
+	/// <summary>
+	/// Struct describing a variable of a natively built graph by its graph names.
+	/// </summary>
+	struct GraphVariableInfo
+	{
+	public:
+		std::string mName;
+		bool mTrainable = true;
+
+		// Tensor reading the variable value
+		std::string mValue;
+
+		// Placeholder and operation assigning the variable
+		std::string mInitialValue;
+		std::string mInitializer;
+	};
+
+	/// <summary>
+	/// Struct describing how a natively built graph is trained, saved next to its SavedModel.
+	/// </summary>
+	struct GraphTrainingInfo
+	{
+	public:
+		static constexpr const char* Filename = "native_training.json";
+	public:
+		/// <summary>
+		/// Read the training info from a JSON file.
+		/// </summary>
+		/// <param name="filepath">The file path</param>
+		void ReadFromFile(const std::filesystem::path& filepath);
+
+		/// <summary>
+		/// Write the training info to a JSON file.
+		/// </summary>
+		/// <param name="filepath">The file path</param>
+		void WriteToFile(const std::filesystem::path& filepath) const;
+	private:
+		nlohmann::json to_json() const;
+
+		static GraphTrainingInfo from_json(const nlohmann::json& inputJson);
+	public:
+		std::vector<GraphVariableInfo> mVariables;
+
+		// Assignments of the non-trainable variables run by each training step
+		std::vector<std::string> mUpdateOps;
+
+		// Scalar input switching the graph to its training behavior, empty if unused
+		std::string mTrainingFlag;
+
+		// Checkpoint prefix input and tensor writing the checkpoint, as in the SaverDef
+		std::string mSaveFilename;
+		std::string mSaveTensor;
+	};
+
+	/// <summary>
+	/// Class building a TensorFlow graph from a ModelLayout through the C API, mirroring the
+	/// Keras layers built by build_model_from_json.py without requiring Python.
+	///
+	/// Layers compute in float32, and the graph inputs/outputs are named after the layout's
+	/// inputs/outputs so the saved model exposes the same serving signature.
+	/// </summary>
+	class GraphBuilder
+	{
+	public:
+		// Bumped whenever the built graphs change, invalidating previous builds
+		static constexpr uint32_t Version = 2;
+	public:
+		/// <summary>
+		/// Constructor initializing a GraphBuilder with an empty graph.
+		/// </summary>
+		/// <param name="seed">The seed of the weight initialization and dropout</param>
+		GraphBuilder(uint64_t seed = 0);
+
+		/// <summary>
+		/// Constructor initializing a GraphBuilder extending an existing graph.
+		/// </summary>
+		/// <param name="graph">The graph</param>
+		/// <param name="seed">The seed of the weight initialization and dropout</param>
+		GraphBuilder(std::shared_ptr<TF_Graph> graph,
+					 uint64_t seed = 0);
+	public:
+		/// <summary>
+		/// Builds the graph of the layout.
+		/// </summary>
+		/// <param name="layout">The model layout</param>
+		/// <returns>True if every layer could be built</returns>
+		bool Build(const ModelLayout& layout);
+
+		/// <summary>
+		/// Initializes the variables and writes the graph as a SavedModel, loadable like the
+		/// SavedModels exported by Keras, along with its GraphTrainingInfo.
+		/// </summary>
+		/// <param name="export_dir">The SavedModel directory</param>
+		/// <returns>True if the SavedModel was written</returns>
+		bool Save(const std::filesystem::path& export_dir) const;
+
+		/// <summary>
+		/// Assigns the initial values of the variables added by the builder.
+		/// </summary>
+		/// <param name="session">A session over the built graph</param>
+		/// <returns>True if the variables were initialized</returns>
+		bool InitializeVariables(const Session& session) const;
+
+		/// <summary>
+		/// Retrieves the built graph.
+		/// </summary>
+		/// <returns>The graph</returns>
+		std::shared_ptr<TF_Graph> GetGraph() const { return mpGraph; }
+
+		/// <summary>
+		/// Retrieves the variables of the built graph.
+		/// </summary>
+		/// <returns>The variables</returns>
+		const std::vector<GraphVariable>& GetVariables() const { return mVariables; }
+
+		/// <summary>
+		/// Retrieves the serving signature of the built graph.
+		/// </summary>
+		/// <returns>The signature</returns>
+		const SignatureDef& GetSignature() const { return mSignature; }
+
+		/// <summary>
+		/// Retrieves the names of the variables and operations used to train the built graph.
+		/// </summary>
+		/// <returns>The training info</returns>
+		GraphTrainingInfo GetTrainingInfo() const;
+
+		/// <summary>
+		/// Retrieves the first error of the build.
+		/// </summary>
+		/// <returns>The error message, empty if every operation was added</returns>
+		const std::string& GetError() const { return mError; }
+	public:
+		/// <summary>
+		/// Adds an operation to the graph. Once an operation fails, every following call
+		/// is skipped so layers can be built without checking each step.
+		/// </summary>
+		/// <param name="type">The operation type</param>
+		/// <param name="name">The unique operation name</param>
+		/// <param name="inputs">The operation inputs</param>
+		/// <param name="attributes">Optional callback setting the operation attributes</param>
+		/// <returns>The first output of the operation, or a null output on failure</returns>
+		TF_Output AddOp(const char* type,
+						const std::string& name,
+						const std::vector<TF_Output>& inputs,
+						const std::function<void(TF_OperationDescription*)>& attributes = nullptr);
+
+		/// <summary>
+		/// Adds a constant to the graph.
+		/// </summary>
+		/// <param name="name">The operation name</param>
+		/// <param name="value">The constant value</param>
+		/// <returns>The constant output</returns>
+		TF_Output AddConst(const std::string& name,
+						   const cppflow::tensor& value);
+
+		TF_Output AddFloatConst(const std::string& name,
+								float value);
+
+		TF_Output AddInt32Const(const std::string& name,
+								const std::vector<int32_t>& values);
+
+		TF_Output AddInt64Const(const std::string& name,
+								const std::vector<int64_t>& values);
+
+		/// <summary>
+		/// Adds a float32 resource variable to the graph.
+		/// </summary>
+		/// <param name="name">The variable name</param>
+		/// <param name="shape">The variable shape</param>
+		/// <param name="initial_data">The initial value</param>
+		/// <param name="trainable">Whether the variable is updated by the optimizer</param>
+		/// <returns>The value of the variable</returns>
+		TF_Output AddVariable(const std::string& name,
+							  const std::vector<int64_t>& shape,
+							  std::vector<float> initial_data,
+							  bool trainable = true);
+
+		/// <summary>
+		/// Retrieves the statically known shape of a graph tensor, unknown dimensions being -1.
+		/// </summary>
+		/// <param name="output">The graph tensor</param>
+		/// <returns>The shape, empty for unknown ranks or scalars</returns>
+		std::vector<int64_t> GetShape(TF_Output output) const;
+
+		/// <summary>
+		/// Records a build error, stopping any further operations from being added.
+		/// </summary>
+		/// <param name="message">The error message</param>
+		/// <returns>A null output</returns>
+		TF_Output Fail(const std::string& message);
+	private:
+		/// <summary>
+		/// Retrieves the "training" scalar input, 0 by default, switching dropout and batch
+		/// normalization to their training behavior when fed 1.
+		/// </summary>
+		/// <returns>The training flag</returns>
+		TF_Output GetTrainingFlag();
+
+		/// <summary>
+		/// Retrieves a named layer input, cast to float32.
+		/// </summary>
+		/// <param name="name">The input or layer output name</param>
+		/// <param name="output">The graph tensor</param>
+		/// <returns>True if the name was defined by a previous layer</returns>
+		bool GetLayerInput(const std::string& name,
+						   TF_Output& output);
+
+		/// <summary>
+		/// Applies a Keras activation by name, a null activation being linear.
+		/// </summary>
+		TF_Output AddActivation(const std::string& scope,
+								TF_Output x,
+								const nlohmann::json& activation);
+
+		TF_Output AddDense(const std::string& scope,
+						   TF_Output x,
+						   const Layer& layer);
+
+		TF_Output AddConvolution(const std::string& scope,
+								 TF_Output x,
+								 const Layer& layer,
+								 bool one_dimensional);
+
+		TF_Output AddMaxPooling(const std::string& scope,
+								TF_Output x,
+								const Layer& layer);
+
+		TF_Output AddFlatten(const std::string& scope,
+							 TF_Output x);
+
+		TF_Output AddDropout(const std::string& scope,
+							 TF_Output x,
+							 const Layer& layer);
+
+		TF_Output AddBatchNormalization(const std::string& scope,
+										TF_Output x,
+										const Layer& layer);
+
+		/// <summary>
+		/// Adds the checkpoint save/restore operations used by the SavedModel loader.
+		/// </summary>
+		void AddSaveOps();
+
+		/// <summary>
+		/// Generates Glorot uniform initial weights.
+		/// </summary>
+		std::vector<float> GlorotUniform(int64_t fan_in,
+										 int64_t fan_out,
+										 size_t count);
+	private:
+		std::shared_ptr<TF_Graph> mpGraph = nullptr;
+
+		// Graph tensors by layout input and layer output name
+		std::unordered_map<std::string, TF_Output> mTensors;
+
+		std::vector<GraphVariable> mVariables;
+
+		// Assignments of the non-trainable variables run by each training step
+		std::vector<TF_Operation*> mUpdateOps;
+
+		TF_Output mTrainingFlag = {};
+		SignatureDef mSignature;
+
+		std::mt19937_64 mRandom;
+		uint64_t mSeed = 0;
+
+		std::string mError;
+	};
+}
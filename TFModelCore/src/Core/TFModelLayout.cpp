@@ -1,5 +1,7 @@
 #include "Core/TFModelLayout.h"
 
+#include "Utils/HashUtils.h"
+
 #include <iostream>
 #include <fstream>
 
@@ -167,6 +169,13 @@ namespace TF
 		ofs << to_json().dump(4);
 	}
 
+	uint64_t ModelLayout::ComputeHash() const
+	{
+		// JSON objects are key ordered, making the compact dump a canonical form of the layout
+		const std::string canonical = to_json().dump();
+		return HashUtils::HashBytes(canonical.data(), canonical.size());
+	}
+
 
 	nlohmann::json ModelLayout::to_json() const
 	{
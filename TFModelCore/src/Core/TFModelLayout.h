@@ -103,6 +103,13 @@ namespace TF
 		/// </summary>
 		/// <param name="filepath">The file path</param>
 		void WriteToFile(const std::filesystem::path& filepath) const;
+
+		/// <summary>
+		/// Computes a hash of the canonical form of the layout. Layer parameters are hashed
+		/// by key order, so equal layouts hash equally regardless of how they were built.
+		/// </summary>
+		/// <returns>The layout hash</returns>
+		uint64_t ComputeHash() const;
 	private:
 		/// <summary>
 		/// Convert the model layout to a JSON object.
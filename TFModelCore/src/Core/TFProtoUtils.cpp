@@ -0,0 +1,105 @@
+#include "Core/TFProtoUtils.h"
+
+namespace TF
+{
+	ProtoReader::ProtoReader(std::string_view data)
+		: mData(data)
+	{
+	}
+
+	bool ProtoReader::ReadVarint(uint64_t& value)
+	{
+		value = 0;
+		for (uint32_t shift = 0; shift < 64; shift += 7)
+		{
+			if (AtEnd())
+				return false;
+
+			const uint8_t byte = static_cast<uint8_t>(mData[mOffset++]);
+			value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	bool ProtoReader::ReadTag(uint32_t& field,
+							  uint32_t& wire_type)
+	{
+		uint64_t tag;
+		if (!ReadVarint(tag))
+			return false;
+
+		field = static_cast<uint32_t>(tag >> 3);
+		wire_type = static_cast<uint32_t>(tag & 0x7);
+		return true;
+	}
+
+	bool ProtoReader::ReadLengthDelimited(std::string_view& value)
+	{
+		uint64_t length;
+		if (!ReadVarint(length) || length > mData.size() - mOffset)
+			return false;
+
+		value = mData.substr(mOffset, static_cast<size_t>(length));
+		mOffset += static_cast<size_t>(length);
+		return true;
+	}
+
+	bool ProtoReader::Skip(uint32_t wire_type)
+	{
+		uint64_t value;
+		std::string_view bytes;
+		switch (wire_type)
+		{
+		case WireVarint:
+			return ReadVarint(value);
+		case WireFixed64:
+			return Advance(8);
+		case WireLengthDelimited:
+			return ReadLengthDelimited(bytes);
+		case WireFixed32:
+			return Advance(4);
+		default:
+			// Groups are deprecated and never used by the TensorFlow messages
+			return false;
+		}
+	}
+
+	bool ProtoReader::Advance(size_t count)
+	{
+		if (count > mData.size() - mOffset)
+			return false;
+
+		mOffset += count;
+		return true;
+	}
+
+	void WriteVarint(std::string& out,
+					 uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+		out.push_back(static_cast<char>(value));
+	}
+
+	void WriteVarintField(std::string& out,
+						  uint32_t field,
+						  uint64_t value)
+	{
+		WriteVarint(out, (static_cast<uint64_t>(field) << 3) | WireVarint);
+		WriteVarint(out, value);
+	}
+
+	void WriteLengthDelimitedField(std::string& out,
+								   uint32_t field,
+								   std::string_view value)
+	{
+		WriteVarint(out, (static_cast<uint64_t>(field) << 3) | WireLengthDelimited);
+		WriteVarint(out, value.size());
+		out.append(value.data(), value.size());
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace TF
+{
+	// Protobuf wire types
+	static constexpr uint32_t WireVarint			= 0;
+	static constexpr uint32_t WireFixed64			= 1;
+	static constexpr uint32_t WireLengthDelimited	= 2;
+	static constexpr uint32_t WireFixed32			= 5;
+
+	/// <summary>
+	/// Class representing a minimal forward-only reader over a serialized protobuf message,
+	/// used to read the few TensorFlow messages the C API only exposes in serialized form.
+	/// </summary>
+	class ProtoReader
+	{
+	public:
+		/// <summary>
+		/// Constructor initializing a ProtoReader over the given bytes.
+		/// </summary>
+		/// <param name="data">The serialized message</param>
+		ProtoReader(std::string_view data);
+	public:
+		/// <summary>
+		/// Checks whether the whole message was read.
+		/// </summary>
+		/// <returns>True if there are no more fields</returns>
+		bool AtEnd() const { return mOffset >= mData.size(); }
+
+		/// <summary>
+		/// Reads a base 128 varint.
+		/// </summary>
+		/// <param name="value">The read value</param>
+		/// <returns>True if the varint was complete</returns>
+		bool ReadVarint(uint64_t& value);
+
+		/// <summary>
+		/// Reads the tag of the next field.
+		/// </summary>
+		/// <param name="field">The field number</param>
+		/// <param name="wire_type">The wire type of the field</param>
+		/// <returns>True if the tag was complete</returns>
+		bool ReadTag(uint32_t& field,
+					 uint32_t& wire_type);
+
+		/// <summary>
+		/// Reads a length delimited field value (string, bytes or nested message) without copying it.
+		/// </summary>
+		/// <param name="value">The view of the value</param>
+		/// <returns>True if the value was complete</returns>
+		bool ReadLengthDelimited(std::string_view& value);
+
+		/// <summary>
+		/// Skips a field value of the given wire type.
+		/// </summary>
+		/// <param name="wire_type">The wire type of the field</param>
+		/// <returns>True if the value could be skipped</returns>
+		bool Skip(uint32_t wire_type);
+	private:
+		/// <summary>
+		/// Advances past a number of bytes.
+		/// </summary>
+		/// <param name="count">The number of bytes</param>
+		/// <returns>True if the bytes were available</returns>
+		bool Advance(size_t count);
+	private:
+		std::string_view mData;
+		size_t mOffset = 0;
+	};
+
+	/// <summary>
+	/// Appends a base 128 varint to a serialized message.
+	/// </summary>
+	/// <param name="out">The serialized message</param>
+	/// <param name="value">The value</param>
+	void WriteVarint(std::string& out,
+					 uint64_t value);
+
+	/// <summary>
+	/// Appends a varint field (integers, booleans and enums) to a serialized message.
+	/// Negative integers are passed as their two's complement.
+	/// </summary>
+	/// <param name="out">The serialized message</param>
+	/// <param name="field">The field number</param>
+	/// <param name="value">The value</param>
+	void WriteVarintField(std::string& out,
+						  uint32_t field,
+						  uint64_t value);
+
+	/// <summary>
+	/// Appends a length delimited field (string, bytes or nested message) to a serialized message.
+	/// </summary>
+	/// <param name="out">The serialized message</param>
+	/// <param name="field">The field number</param>
+	/// <param name="value">The value</param>
+	void WriteLengthDelimitedField(std::string& out,
+								   uint32_t field,
+								   std::string_view value);
+}
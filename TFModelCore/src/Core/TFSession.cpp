@@ -0,0 +1,215 @@
+#include "Core/TFSession.h"
+
+#include <iostream>
+
+namespace TF
+{
+	using SessionOptionsPtr = std::unique_ptr<TF_SessionOptions, decltype(&TF_DeleteSessionOptions)>;
+
+	static SessionOptionsPtr CreateSessionOptions(const SessionConfig& config)
+	{
+		std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)> status(TF_NewStatus(), TF_DeleteStatus);
+		SessionOptionsPtr options(TF_NewSessionOptions(), TF_DeleteSessionOptions);
+
+		const std::string config_proto = config.SerializeConfigProto();
+		if (!config_proto.empty())
+		{
+			TF_SetConfig(options.get(), config_proto.data(), config_proto.size(), status.get());
+			if (TF_GetCode(status.get()) != TF_OK)
+				throw std::runtime_error(std::string("Invalid Session Config: ") + TF_Message(status.get()));
+		}
+		return options;
+	}
+
+	static std::shared_ptr<TF_Session> WrapSession(TF_Session* session)
+	{
+		return std::shared_ptr<TF_Session>(session, [](TF_Session* session)
+		{
+			std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)> status(TF_NewStatus(), TF_DeleteStatus);
+			TF_CloseSession(session, status.get());
+			TF_DeleteSession(session, status.get());
+		});
+	}
+
+	Session::Session(const std::filesystem::path& saved_model_path,
+					 const SessionConfig& config)
+	{
+		std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)> status(TF_NewStatus(), TF_DeleteStatus);
+		const SessionOptionsPtr options = CreateSessionOptions(config);
+
+		mpGraph = std::shared_ptr<TF_Graph>(TF_NewGraph(), TF_DeleteGraph);
+
+		const std::string export_dir = saved_model_path.string();
+		const char* tags[] = { "serve" };
+
+		std::unique_ptr<TF_Buffer, decltype(&TF_DeleteBuffer)> meta_graph_def(TF_NewBuffer(), TF_DeleteBuffer);
+
+		TF_Session* session = TF_LoadSessionFromSavedModel(options.get(),
+														   nullptr,
+														   export_dir.c_str(),
+														   tags,
+														   1,
+														   mpGraph.get(),
+														   meta_graph_def.get(),
+														   status.get());
+		if (TF_GetCode(status.get()) != TF_OK)
+			throw std::runtime_error("Failed to Load SavedModel {" + export_dir + "}: " + TF_Message(status.get()));
+
+		if (!ParseSignatureDefs(meta_graph_def->data, meta_graph_def->length, mSignatures))
+			std::cerr << "Failed to Parse Signatures Of SavedModel {" << export_dir << "}" << std::endl;
+
+		mpSession = WrapSession(session);
+	}
+
+	Session::Session(std::shared_ptr<TF_Graph> graph,
+					 std::unordered_map<std::string, SignatureDef> signatures,
+					 const SessionConfig& config)
+		: mpGraph(std::move(graph)),
+		mSignatures(std::move(signatures))
+	{
+		std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)> status(TF_NewStatus(), TF_DeleteStatus);
+		const SessionOptionsPtr options = CreateSessionOptions(config);
+
+		TF_Session* session = TF_NewSession(mpGraph.get(), options.get(), status.get());
+		if (TF_GetCode(status.get()) != TF_OK)
+			throw std::runtime_error(std::string("Failed to Create Session: ") + TF_Message(status.get()));
+
+		mpSession = WrapSession(session);
+	}
+
+	bool Session::ResolveOutput(const std::string& name,
+								TF_Output& output) const
+	{
+		std::string op_name = name;
+		int index = 0;
+
+		const size_t pos = name.find(':');
+		if (pos != std::string::npos)
+		{
+			op_name = name.substr(0, pos);
+			index = std::stoi(name.substr(pos + 1));
+		}
+
+		TF_Operation* op = TF_GraphOperationByName(mpGraph.get(), op_name.c_str());
+		if (!op)
+			return false;
+
+		output = { op, index };
+		return true;
+	}
+
+	bool Session::GetTensorSpec(const std::string& name,
+								TF_DataType& dtype,
+								std::vector<int64_t>& shape) const
+	{
+		TF_Output output;
+		if (!ResolveOutput(name, output))
+			return false;
+
+		std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)> status(TF_NewStatus(), TF_DeleteStatus);
+
+		const int num_dims = TF_GraphGetTensorNumDims(mpGraph.get(), output, status.get());
+		if (TF_GetCode(status.get()) != TF_OK || num_dims < 0)
+			return false;
+
+		shape.resize(num_dims);
+		TF_GraphGetTensorShape(mpGraph.get(), output, shape.data(), num_dims, status.get());
+		if (TF_GetCode(status.get()) != TF_OK)
+			return false;
+
+		dtype = TF_OperationOutputType(output);
+		return true;
+	}
+
+	const SignatureDef* Session::GetSignature(const std::string& key) const
+	{
+		auto found = mSignatures.find(key);
+		return found != mSignatures.end() ? &found->second : nullptr;
+	}
+
+	bool Session::Run(const TF_Output* inputs,
+					  TF_Tensor* const* input_values,
+					  int input_count,
+					  const TF_Output* outputs,
+					  TF_Tensor** output_values,
+					  int output_count,
+					  const TF_Operation* const* targets,
+					  int target_count) const
+	{
+		// A status per call keeps concurrent runs from racing on the error state
+		std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)> status(TF_NewStatus(), TF_DeleteStatus);
+
+		mInFlight.fetch_add(1, std::memory_order_relaxed);
+		TF_SessionRun(mpSession.get(),
+					  nullptr,
+					  inputs,
+					  input_values,
+					  input_count,
+					  outputs,
+					  output_values,
+					  output_count,
+					  targets,
+					  target_count,
+					  nullptr,
+					  status.get());
+		mInFlight.fetch_sub(1, std::memory_order_relaxed);
+
+		if (TF_GetCode(status.get()) != TF_OK)
+		{
+			std::cerr << "Failed Session Run: " << TF_Message(status.get()) << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	bool Session::Run(const std::vector<std::tuple<std::string, cppflow::tensor>>& inputs,
+					  const std::vector<std::string>& outputs,
+					  std::vector<cppflow::tensor>& results) const
+	{
+		std::vector<TF_Output> input_ops(inputs.size());
+		std::vector<TF_Tensor*> input_values(inputs.size());
+
+		// Keep the resolved input tensors alive for the duration of the run
+		std::vector<std::shared_ptr<TF_Tensor>> input_tensors(inputs.size());
+		for (size_t i = 0; i < inputs.size(); ++i)
+		{
+			const auto& [name, tensor] = inputs[i];
+			if (!ResolveOutput(name, input_ops[i]))
+			{
+				std::cerr << "Input operation '" << name << "' not found in graph." << std::endl;
+				return false;
+			}
+
+			input_tensors[i] = tensor.get_tensor();
+			input_values[i] = input_tensors[i].get();
+		}
+
+		std::vector<TF_Output> output_ops(outputs.size());
+		for (size_t i = 0; i < outputs.size(); ++i)
+		{
+			if (!ResolveOutput(outputs[i], output_ops[i]))
+			{
+				std::cerr << "Output operation '" << outputs[i] << "' not found in graph." << std::endl;
+				return false;
+			}
+		}
+
+		std::vector<TF_Tensor*> output_values(outputs.size(), nullptr);
+		if (!Run(input_ops.data(),
+				 input_values.data(),
+				 static_cast<int>(input_ops.size()),
+				 output_ops.data(),
+				 output_values.data(),
+				 static_cast<int>(output_ops.size())))
+		{
+			return false;
+		}
+
+		results.clear();
+		results.reserve(output_values.size());
+		for (TF_Tensor* value : output_values)
+			results.emplace_back(value);
+
+		return true;
+	}
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "CppFlowLib.h"
+#include "Core/TFSessionConfig.h"
+#include "Core/TFSignatureDef.h"
+
+#include <string>
+#include <vector>
+#include <tuple>
+#include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <filesystem>
+
+namespace TF
+{
+	/// <summary>
+	/// Class wrapping a TensorFlow session loaded from a SavedModel.
+	///
+	/// Unlike cppflow::model, running the session does not share any mutable state
+	/// between calls, so a single session can be run concurrently from multiple threads.
+	/// </summary>
+	class Session
+	{
+	public:
+		/// <summary>
+		/// Constructor loading the SavedModel at the given path. Throws on failure.
+		/// </summary>
+		/// <param name="saved_model_path">The SavedModel directory</param>
+		/// <param name="config">The session threading and optimizer configuration</param>
+		Session(const std::filesystem::path& saved_model_path,
+				const SessionConfig& config = {});
+
+		/// <summary>
+		/// Constructor creating a session over an already loaded graph. Throws on failure.
+		/// The variables of the new session are uninitialized.
+		/// </summary>
+		/// <param name="graph">The graph, shared with its other sessions</param>
+		/// <param name="signatures">The signatures of the graph</param>
+		/// <param name="config">The session threading and optimizer configuration</param>
+		Session(std::shared_ptr<TF_Graph> graph,
+				std::unordered_map<std::string, SignatureDef> signatures,
+				const SessionConfig& config = {});
+	public:
+		/// <summary>
+		/// Resolves a graph tensor name in the form "operation:index" to its graph output.
+		/// </summary>
+		/// <param name="name">The tensor name</param>
+		/// <param name="output">The resolved graph output</param>
+		/// <returns>True if the operation exists in the graph</returns>
+		bool ResolveOutput(const std::string& name,
+						   TF_Output& output) const;
+
+		/// <summary>
+		/// Retrieves the data type and statically known shape of a graph tensor.
+		/// Unknown dimensions are reported as -1.
+		/// </summary>
+		/// <param name="name">The tensor name</param>
+		/// <param name="dtype">The data type of the tensor</param>
+		/// <param name="shape">The shape of the tensor</param>
+		/// <returns>True if the tensor exists and has a known rank</returns>
+		bool GetTensorSpec(const std::string& name,
+						   TF_DataType& dtype,
+						   std::vector<int64_t>& shape) const;
+
+		/// <summary>
+		/// Runs the session with resolved graph inputs/outputs.
+		/// Ownership of the produced output tensors is passed to the caller.
+		/// </summary>
+		/// <param name="inputs">The graph inputs</param>
+		/// <param name="input_values">The input tensors</param>
+		/// <param name="input_count">The number of inputs</param>
+		/// <param name="outputs">The graph outputs to fetch</param>
+		/// <param name="output_values">The fetched output tensors</param>
+		/// <param name="output_count">The number of outputs</param>
+		/// <param name="targets">Optional operations to run without fetching an output</param>
+		/// <param name="target_count">The number of target operations</param>
+		/// <returns>True if the run was successful</returns>
+		bool Run(const TF_Output* inputs,
+				 TF_Tensor* const* input_values,
+				 int input_count,
+				 const TF_Output* outputs,
+				 TF_Tensor** output_values,
+				 int output_count,
+				 const TF_Operation* const* targets = nullptr,
+				 int target_count = 0) const;
+
+		/// <summary>
+		/// Runs the session with named graph inputs/outputs.
+		/// </summary>
+		/// <param name="inputs">The graph input names and tensors</param>
+		/// <param name="outputs">The graph output names to fetch</param>
+		/// <param name="results">The fetched output tensors</param>
+		/// <returns>True if the run was successful</returns>
+		bool Run(const std::vector<std::tuple<std::string, cppflow::tensor>>& inputs,
+				 const std::vector<std::string>& outputs,
+				 std::vector<cppflow::tensor>& results) const;
+
+		/// <summary>
+		/// Retrieves a signature of the loaded SavedModel.
+		/// </summary>
+		/// <param name="key">The signature key</param>
+		/// <returns>The signature or nullptr if the SavedModel has no such signature</returns>
+		const SignatureDef* GetSignature(const std::string& key = "serving_default") const;
+
+		/// <summary>
+		/// Retrieves every signature of the loaded SavedModel.
+		/// </summary>
+		/// <returns>The signatures by key</returns>
+		const std::unordered_map<std::string, SignatureDef>& GetSignatures() const { return mSignatures; }
+
+		/// <summary>
+		/// Retrieves the graph of the session. Operations added to it are visible to the
+		/// session on its next run.
+		/// </summary>
+		/// <returns>The graph</returns>
+		std::shared_ptr<TF_Graph> GetGraph() const { return mpGraph; }
+
+		/// <summary>
+		/// Retrieves the number of runs currently executing on the session.
+		/// </summary>
+		/// <returns>The number of in-flight runs</returns>
+		uint32_t GetInFlightCount() const { return mInFlight.load(std::memory_order_relaxed); }
+	private:
+		std::shared_ptr<TF_Graph> mpGraph = nullptr;
+		std::shared_ptr<TF_Session> mpSession = nullptr;
+
+		std::unordered_map<std::string, SignatureDef> mSignatures;
+
+		mutable std::atomic<uint32_t> mInFlight = 0;
+	};
+}
@@ -0,0 +1,83 @@
+#include "Core/TFSessionConfig.h"
+#include "Core/TFProtoUtils.h"
+
+#include "Utils/ConsoleUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+namespace TF
+{
+	// tensorflow.ConfigProto / GraphOptions / OptimizerOptions field numbers
+	static constexpr uint32_t IntraOpParallelismThreadsField	= 2;
+	static constexpr uint32_t InterOpParallelismThreadsField	= 5;
+	static constexpr uint32_t UsePerSessionThreadsField			= 9;
+	static constexpr uint32_t GraphOptionsField					= 10;
+	static constexpr uint32_t OptimizerOptionsField				= 3;
+	static constexpr uint32_t GlobalJitLevelField				= 5;
+
+	// tensorflow.OptimizerOptions.GlobalJitLevel.ON_1
+	static constexpr uint32_t GlobalJitLevelOn = 1;
+
+	SessionConfig SessionConfig::Auto(uint32_t concurrent_models)
+	{
+		const uint32_t cores = std::max(1u, std::thread::hardware_concurrency());
+		const uint32_t models = std::max(1u, concurrent_models);
+
+		SessionConfig config;
+		config.mIntraOpThreads = std::max(1u, cores / models);
+		config.mInterOpThreads = config.mIntraOpThreads > 4 ? 2 : 1;
+
+		// Separate pools keep models sharing the machine from contending for the same threads
+		config.mPerSessionThreads = models > 1;
+		return config;
+	}
+
+	std::string SessionConfig::SerializeConfigProto() const
+	{
+		std::string proto;
+		if (mIntraOpThreads > 0)
+			WriteVarintField(proto, IntraOpParallelismThreadsField, mIntraOpThreads);
+		if (mInterOpThreads > 0)
+			WriteVarintField(proto, InterOpParallelismThreadsField, mInterOpThreads);
+		if (mPerSessionThreads)
+			WriteVarintField(proto, UsePerSessionThreadsField, 1);
+
+		if (mEnableXLA)
+		{
+			std::string optimizer_options;
+			WriteVarintField(optimizer_options, GlobalJitLevelField, GlobalJitLevelOn);
+
+			std::string graph_options;
+			WriteLengthDelimitedField(graph_options, OptimizerOptionsField, optimizer_options);
+
+			WriteLengthDelimitedField(proto, GraphOptionsField, graph_options);
+		}
+		return proto;
+	}
+
+	void SessionConfig::ApplyEnvironment() const
+	{
+		static std::atomic<bool> applied = false;
+		if (applied.exchange(true))
+		{
+			std::cerr << "Session Environment Already Applied, Ignoring." << std::endl;
+			return;
+		}
+
+		// The global jit level alone only covers GPU clusters
+		if (mEnableXLA)
+			ConsoleUtils::SetEnvironment("TF_XLA_FLAGS", "--tf_xla_cpu_global_jit", false);
+
+		if (mEnableOneDNN.has_value())
+			ConsoleUtils::SetEnvironment("TF_ENABLE_ONEDNN_OPTS", *mEnableOneDNN ? "1" : "0", true);
+
+		if (mPinThreads)
+		{
+			ConsoleUtils::SetEnvironment("KMP_AFFINITY", "granularity=fine,compact,1,0", false);
+			ConsoleUtils::SetEnvironment("OMP_PROC_BIND", "true", false);
+		}
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace TF
+{
+	/// <summary>
+	/// Struct representing the threading and optimizer configuration of a TensorFlow session.
+	/// </summary>
+	struct SessionConfig
+	{
+	public:
+		/// <summary>
+		/// Creates a configuration splitting the cores of the machine between the given
+		/// number of concurrently serving models.
+		/// </summary>
+		/// <param name="concurrent_models">The number of models sharing the machine</param>
+		/// <returns>The tuned configuration</returns>
+		static SessionConfig Auto(uint32_t concurrent_models = 1);
+
+		/// <summary>
+		/// Serializes the configuration into a tensorflow.ConfigProto message.
+		/// </summary>
+		/// <returns>The serialized message</returns>
+		std::string SerializeConfigProto() const;
+
+		/// <summary>
+		/// Applies the process-wide options (XLA on CPU, oneDNN, thread pinning) through the environment.
+		/// Sessions never apply them: call it once at process start-up, before other threads run and
+		/// before TensorFlow is first used, since setenv races with concurrent getenv calls and
+		/// TensorFlow and OpenMP only read these variables when they initialize. Later calls are ignored.
+		/// </summary>
+		void ApplyEnvironment() const;
+	public:
+		// Threads used to parallelize a single op, 0 lets TensorFlow decide
+		uint32_t mIntraOpThreads = 0;
+
+		// Threads used to run independent ops concurrently, 0 lets TensorFlow decide
+		uint32_t mInterOpThreads = 0;
+
+		// Whether the session owns its thread pools instead of sharing the process-wide ones
+		bool mPerSessionThreads = false;
+
+		// Whether to JIT compile the graph with XLA, on CPU only once applied through ApplyEnvironment
+		bool mEnableXLA = false;
+
+		// Whether to use the oneDNN CPU kernels, unset keeps the TensorFlow default (process-wide, see ApplyEnvironment)
+		std::optional<bool> mEnableOneDNN;
+
+		// Whether to bind the oneDNN/OpenMP worker threads to cores (process-wide, see ApplyEnvironment)
+		bool mPinThreads = false;
+	};
+}
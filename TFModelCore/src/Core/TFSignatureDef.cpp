@@ -0,0 +1,141 @@
+#include "Core/TFSignatureDef.h"
+#include "Core/TFProtoUtils.h"
+
+namespace TF
+{
+	// tensorflow.MetaGraphDef / SignatureDef / TensorInfo field numbers
+	static constexpr uint32_t SignatureDefField		= 5;
+	static constexpr uint32_t MapKeyField			= 1;
+	static constexpr uint32_t MapValueField			= 2;
+	static constexpr uint32_t InputsField			= 1;
+	static constexpr uint32_t OutputsField			= 2;
+	static constexpr uint32_t TensorNameField		= 1;
+
+	/// <summary>
+	/// Reads the key and serialized value of a protobuf map entry.
+	/// </summary>
+	static bool ParseMapEntry(std::string_view entry,
+							  std::string& key,
+							  std::string_view& value)
+	{
+		ProtoReader reader(entry);
+		while (!reader.AtEnd())
+		{
+			uint32_t field, wire_type;
+			if (!reader.ReadTag(field, wire_type))
+				return false;
+
+			std::string_view bytes;
+			if (field == MapKeyField && wire_type == WireLengthDelimited)
+			{
+				if (!reader.ReadLengthDelimited(bytes))
+					return false;
+				key = std::string(bytes);
+			}
+			else if (field == MapValueField && wire_type == WireLengthDelimited)
+			{
+				if (!reader.ReadLengthDelimited(value))
+					return false;
+			}
+			else if (!reader.Skip(wire_type))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static bool ParseTensorInfo(std::string_view message,
+								std::string& name)
+	{
+		ProtoReader reader(message);
+		while (!reader.AtEnd())
+		{
+			uint32_t field, wire_type;
+			if (!reader.ReadTag(field, wire_type))
+				return false;
+
+			std::string_view bytes;
+			if (field == TensorNameField && wire_type == WireLengthDelimited)
+			{
+				if (!reader.ReadLengthDelimited(bytes))
+					return false;
+				name = std::string(bytes);
+			}
+			else if (!reader.Skip(wire_type))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static bool ParseSignatureDef(std::string_view message,
+								  SignatureDef& signature)
+	{
+		ProtoReader reader(message);
+		while (!reader.AtEnd())
+		{
+			uint32_t field, wire_type;
+			if (!reader.ReadTag(field, wire_type))
+				return false;
+
+			if ((field == InputsField || field == OutputsField) && wire_type == WireLengthDelimited)
+			{
+				std::string_view entry, value;
+				if (!reader.ReadLengthDelimited(entry))
+					return false;
+
+				std::string key, name;
+				if (!ParseMapEntry(entry, key, value) || !ParseTensorInfo(value, name))
+					return false;
+
+				// Sparse and composite tensors have no single name and are left out
+				if (name.empty())
+					continue;
+
+				if (field == InputsField)
+					signature.mInputs[key] = name;
+				else
+					signature.mOutputs[key] = name;
+			}
+			else if (!reader.Skip(wire_type))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool ParseSignatureDefs(const void* data,
+							size_t length,
+							std::unordered_map<std::string, SignatureDef>& signatures)
+	{
+		ProtoReader reader(std::string_view(static_cast<const char*>(data), length));
+		while (!reader.AtEnd())
+		{
+			uint32_t field, wire_type;
+			if (!reader.ReadTag(field, wire_type))
+				return false;
+
+			if (field == SignatureDefField && wire_type == WireLengthDelimited)
+			{
+				std::string_view entry, value;
+				if (!reader.ReadLengthDelimited(entry))
+					return false;
+
+				std::string key;
+				SignatureDef signature;
+				if (!ParseMapEntry(entry, key, value) || !ParseSignatureDef(value, signature))
+					return false;
+
+				signatures[key] = std::move(signature);
+			}
+			else if (!reader.Skip(wire_type))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+namespace TF
+{
+	/// <summary>
+	/// Struct representing a SavedModel signature, mapping the signature's input/output keys
+	/// to their graph tensor names ("operation:index").
+	/// </summary>
+	struct SignatureDef
+	{
+	public:
+		std::map<std::string, std::string> mInputs;
+		std::map<std::string, std::string> mOutputs;
+	};
+
+	/// <summary>
+	/// Parses the signatures of a serialized tensorflow.MetaGraphDef, as returned when loading a SavedModel.
+	/// Only the dense tensor names are read, the remainder of the message is skipped without being decoded.
+	/// </summary>
+	/// <param name="data">The serialized MetaGraphDef</param>
+	/// <param name="length">The number of bytes</param>
+	/// <param name="signatures">The signatures by key</param>
+	/// <returns>True if the message could be parsed</returns>
+	bool ParseSignatureDefs(const void* data,
+							size_t length,
+							std::unordered_map<std::string, SignatureDef>& signatures);
+}
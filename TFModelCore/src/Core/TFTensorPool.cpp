@@ -0,0 +1,121 @@
+#include "Core/TFTensorPool.h"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+namespace TF
+{
+	// TensorFlow expects 64 byte aligned buffers, anything else is copied on use
+	static constexpr std::align_val_t TensorAlignment = std::align_val_t(64);
+
+	/// <summary>
+	/// Struct representing the pool state shared between the pool and its outstanding leases.
+	/// </summary>
+	struct TensorPool::State
+	{
+	public:
+		~State()
+		{
+			for (auto& [length, buffers] : mIdleBuffers)
+			{
+				for (void* buffer : buffers)
+					::operator delete(buffer, TensorAlignment);
+			}
+		}
+	public:
+		uint32_t mMaxCachedPerSize = 0;
+
+		// One reference for the pool plus one per outstanding lease
+		std::atomic<uint32_t> mRefCount = 1;
+
+		std::unordered_map<size_t, std::vector<void*>> mIdleBuffers;
+		mutable std::mutex mMutex = {};
+		bool mClosed = false;
+	};
+
+	TensorPool::TensorPool(uint32_t max_cached_per_size)
+		: mpState(new State())
+	{
+		mpState->mMaxCachedPerSize = max_cached_per_size;
+	}
+
+	TensorPool::~TensorPool()
+	{
+		{
+			const std::scoped_lock lock(mpState->mMutex);
+			mpState->mClosed = true;
+		}
+		ReleaseState(mpState);
+	}
+
+	TF_Tensor* TensorPool::Lease(TF_DataType dtype,
+								 const std::vector<int64_t>& shape)
+	{
+		size_t length = TF_DataTypeSize(dtype);
+		for (int64_t dim : shape)
+			length *= static_cast<size_t>(dim);
+
+		void* buffer = nullptr;
+		{
+			const std::scoped_lock lock(mpState->mMutex);
+			auto found = mpState->mIdleBuffers.find(length);
+			if (found != mpState->mIdleBuffers.end() && !found->second.empty())
+			{
+				buffer = found->second.back();
+				found->second.pop_back();
+			}
+		}
+
+		if (!buffer)
+			buffer = ::operator new(length, TensorAlignment);
+
+		++mpState->mRefCount;
+		return TF_NewTensor(dtype,
+							shape.data(),
+							static_cast<int>(shape.size()),
+							buffer,
+							length,
+							&TensorPool::Release,
+							mpState);
+	}
+
+	size_t TensorPool::GetIdleCount() const
+	{
+		const std::scoped_lock lock(mpState->mMutex);
+
+		size_t count = 0;
+		for (const auto& [length, buffers] : mpState->mIdleBuffers)
+			count += buffers.size();
+		return count;
+	}
+
+	void TensorPool::Release(void* data,
+							 size_t length,
+							 void* arg)
+	{
+		State* state = static_cast<State*>(arg);
+		{
+			const std::scoped_lock lock(state->mMutex);
+
+			std::vector<void*>& buffers = state->mIdleBuffers[length];
+			if (!state->mClosed && buffers.size() < state->mMaxCachedPerSize)
+			{
+				buffers.push_back(data);
+				data = nullptr;
+			}
+		}
+
+		if (data)
+			::operator delete(data, TensorAlignment);
+
+		ReleaseState(state);
+	}
+
+	void TensorPool::ReleaseState(State* state)
+	{
+		if (--state->mRefCount == 0)
+			delete state;
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "CppFlowLib.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace TF
+{
+	/// <summary>
+	/// Class representing a pool of reusable tensor buffers.
+	///
+	/// Leased tensors return their buffer to the pool once the last reference to them is released,
+	/// so repeatedly creating tensors of the same data type and shape does not allocate.
+	/// Leased tensors may safely outlive the pool.
+	/// </summary>
+	class TensorPool
+	{
+	public:
+		/// <summary>
+		/// Constructor initializing a TensorPool.
+		/// </summary>
+		/// <param name="max_cached_per_size">The maximum number of idle buffers kept per buffer size</param>
+		TensorPool(uint32_t max_cached_per_size = 8);
+
+		/// <summary>
+		/// Destructor releasing the idle buffers.
+		/// </summary>
+		~TensorPool();
+
+		TensorPool(const TensorPool&) = delete;
+		TensorPool& operator=(const TensorPool&) = delete;
+	public:
+		/// <summary>
+		/// Leases an uninitialized tensor of the given data type and shape.
+		/// Ownership of the tensor is passed to the caller, typically by wrapping it
+		/// in a cppflow::tensor once its data has been written.
+		/// </summary>
+		/// <param name="dtype">The data type of the tensor</param>
+		/// <param name="shape">The shape of the tensor</param>
+		/// <returns>The leased tensor</returns>
+		TF_Tensor* Lease(TF_DataType dtype,
+						 const std::vector<int64_t>& shape);
+
+		/// <summary>
+		/// Retrieves the number of idle buffers currently held by the pool.
+		/// </summary>
+		/// <returns>The number of idle buffers</returns>
+		size_t GetIdleCount() const;
+	private:
+		struct State;
+
+		/// <summary>
+		/// Tensor deallocator returning the buffer to the pool it was leased from.
+		/// </summary>
+		static void Release(void* data,
+							size_t length,
+							void* arg);
+
+		/// <summary>
+		/// Drops a reference to the shared pool state, deleting it with the last reference.
+		/// </summary>
+		static void ReleaseState(State* state);
+	private:
+		State* mpState = nullptr;
+	};
+}
@@ -0,0 +1,290 @@
+#include "Core/TFTensorUtils.h"
+
+#include <iostream>
+#include <cstring>
+#include <numeric>
+#include <span>
+
+namespace TF
+{
+	std::vector<int64_t> GetTensorShape(const cppflow::tensor& tensor)
+	{
+		const std::shared_ptr<TF_Tensor> tf_tensor = tensor.get_tensor();
+
+		std::vector<int64_t> shape(TF_NumDims(tf_tensor.get()));
+		for (int i = 0; i < static_cast<int>(shape.size()); ++i)
+			shape[i] = TF_Dim(tf_tensor.get(), i);
+		return shape;
+	}
+
+	TF_DataType ToTFDataType(DataType type)
+	{
+		switch (type)
+		{
+		case DataType::Bool:
+			return TF_BOOL;
+		case DataType::UInt8:
+			return TF_UINT8;
+		case DataType::Float32:
+			return TF_FLOAT;
+		case DataType::Float64:
+		case DataType::Double:
+			return TF_DOUBLE;
+		case DataType::Int32:
+			return TF_INT32;
+		case DataType::Int64:
+			return TF_INT64;
+		default:
+			throw std::invalid_argument("Unsupported DataType");
+		}
+		return TF_FLOAT;
+	}
+
+	cppflow::tensor CreateZeroTensor(TF_DataType dtype,
+									 const std::vector<int64_t>& shape)
+	{
+		size_t length = TF_DataTypeSize(dtype);
+		for (int64_t dim : shape)
+			length *= static_cast<size_t>(dim);
+
+		TF_Tensor* tensor = TF_AllocateTensor(dtype, shape.data(), static_cast<int>(shape.size()), length);
+		std::memset(TF_TensorData(tensor), 0, length);
+		return cppflow::tensor(tensor);
+	}
+
+	cppflow::tensor CreateStringTensor(const std::vector<std::string>& values,
+									   const std::vector<int64_t>& shape)
+	{
+		TF_Tensor* tensor = TF_AllocateTensor(TF_STRING, shape.data(), static_cast<int>(shape.size()), values.size() * sizeof(TF_TString));
+
+		TF_TString* data = static_cast<TF_TString*>(TF_TensorData(tensor));
+		for (size_t i = 0; i < values.size(); ++i)
+		{
+			TF_StringInit(&data[i]);
+			TF_StringCopy(&data[i], values[i].data(), values[i].size());
+		}
+		return cppflow::tensor(tensor);
+	}
+
+	void AppendTensorBytes(const cppflow::tensor& tensor,
+						   std::string& bytes)
+	{
+		const std::shared_ptr<TF_Tensor> tf_tensor = tensor.get_tensor();
+
+		const TF_DataType dtype = TF_TensorType(tf_tensor.get());
+		const std::vector<int64_t> shape = GetTensorShape(tensor);
+		const uint64_t rank = shape.size();
+
+		bytes.append(reinterpret_cast<const char*>(&dtype), sizeof(dtype));
+		bytes.append(reinterpret_cast<const char*>(&rank), sizeof(rank));
+		bytes.append(reinterpret_cast<const char*>(shape.data()), shape.size() * sizeof(int64_t));
+		bytes.append(static_cast<const char*>(TF_TensorData(tf_tensor.get())), TF_TensorByteSize(tf_tensor.get()));
+	}
+
+	bool StackTensors(const std::vector<cppflow::tensor>& tensors,
+					  cppflow::tensor& output)
+	{
+		if (tensors.empty())
+			return false;
+
+		std::vector<std::shared_ptr<TF_Tensor>> tf_tensors;
+		tf_tensors.reserve(tensors.size());
+		for (const cppflow::tensor& tensor : tensors)
+			tf_tensors.push_back(tensor.get_tensor());
+
+		const TF_Tensor* first = tf_tensors.front().get();
+		const TF_DataType dtype = TF_TensorType(first);
+		const int num_dims = TF_NumDims(first);
+
+		if (dtype == TF_STRING || num_dims == 0)
+		{
+			std::cerr << "Unsupported Tensor For Stacking." << std::endl;
+			return false;
+		}
+
+		std::vector<int64_t> shape = GetTensorShape(tensors.front());
+		shape[0] = 0;
+
+		size_t byte_size = 0;
+		for (const auto& tf_tensor : tf_tensors)
+		{
+			if (TF_TensorType(tf_tensor.get()) != dtype || TF_NumDims(tf_tensor.get()) != num_dims)
+			{
+				std::cerr << "Mismatched Tensors For Stacking." << std::endl;
+				return false;
+			}
+
+			for (int i = 1; i < num_dims; ++i)
+			{
+				if (TF_Dim(tf_tensor.get(), i) != shape[i])
+				{
+					std::cerr << "Mismatched Tensor Shapes For Stacking." << std::endl;
+					return false;
+				}
+			}
+
+			shape[0] += TF_Dim(tf_tensor.get(), 0);
+			byte_size += TF_TensorByteSize(tf_tensor.get());
+		}
+
+		TF_Tensor* stacked = TF_AllocateTensor(dtype, shape.data(), num_dims, byte_size);
+
+		char* data = static_cast<char*>(TF_TensorData(stacked));
+		for (const auto& tf_tensor : tf_tensors)
+		{
+			const size_t size = TF_TensorByteSize(tf_tensor.get());
+			std::memcpy(data, TF_TensorData(tf_tensor.get()), size);
+			data += size;
+		}
+
+		output = cppflow::tensor(stacked);
+		return true;
+	}
+
+	bool SliceTensor(const cppflow::tensor& tensor,
+					 int64_t begin,
+					 int64_t count,
+					 cppflow::tensor& output)
+	{
+		const std::shared_ptr<TF_Tensor> tf_tensor = tensor.get_tensor();
+
+		const TF_DataType dtype = TF_TensorType(tf_tensor.get());
+		const int num_dims = TF_NumDims(tf_tensor.get());
+		if (dtype == TF_STRING || num_dims == 0)
+		{
+			std::cerr << "Unsupported Tensor For Slicing." << std::endl;
+			return false;
+		}
+
+		std::vector<int64_t> shape = GetTensorShape(tensor);
+		if (begin < 0 || count < 0 || begin + count > shape[0])
+		{
+			std::cerr << "Invalid Tensor Slice Range." << std::endl;
+			return false;
+		}
+
+		const size_t row_size = shape[0] > 0 ? TF_TensorByteSize(tf_tensor.get()) / static_cast<size_t>(shape[0]) : 0;
+		shape[0] = count;
+
+		TF_Tensor* sliced = TF_AllocateTensor(dtype, shape.data(), num_dims, row_size * count);
+		std::memcpy(TF_TensorData(sliced),
+					static_cast<const char*>(TF_TensorData(tf_tensor.get())) + row_size * begin,
+					row_size * count);
+
+		output = cppflow::tensor(sliced);
+		return true;
+	}
+
+	bool GatherTensorRows(const cppflow::tensor& tensor,
+						  const int64_t* rows,
+						  size_t count,
+						  cppflow::tensor& output)
+	{
+		const std::shared_ptr<TF_Tensor> tf_tensor = tensor.get_tensor();
+
+		const TF_DataType dtype = TF_TensorType(tf_tensor.get());
+		const int num_dims = TF_NumDims(tf_tensor.get());
+		if (dtype == TF_STRING || num_dims == 0)
+		{
+			std::cerr << "Unsupported Tensor For Gathering." << std::endl;
+			return false;
+		}
+
+		std::vector<int64_t> shape = GetTensorShape(tensor);
+		const size_t row_size = shape[0] > 0 ? TF_TensorByteSize(tf_tensor.get()) / static_cast<size_t>(shape[0]) : 0;
+
+		shape[0] = static_cast<int64_t>(count);
+
+		TF_Tensor* gathered = TF_AllocateTensor(dtype, shape.data(), num_dims, row_size * count);
+
+		const char* source = static_cast<const char*>(TF_TensorData(tf_tensor.get()));
+		char* data = static_cast<char*>(TF_TensorData(gathered));
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (rows[i] < 0 || rows[i] >= TF_Dim(tf_tensor.get(), 0))
+			{
+				TF_DeleteTensor(gathered);
+				std::cerr << "Invalid Tensor Gather Row." << std::endl;
+				return false;
+			}
+
+			std::memcpy(data + row_size * i, source + row_size * rows[i], row_size);
+		}
+
+		output = cppflow::tensor(gathered);
+		return true;
+	}
+
+	bool CreateTensorFromColumn(const TrainingColumn& column,
+								TF_DataType dtype,
+								const std::vector<int64_t>& sample_shape,
+								cppflow::tensor& output)
+	{
+		if (column.IsImage() || ToTFDataType(column.mType) != dtype)
+		{
+			std::cerr << "Training data of '" << column.mName << "' does not have the tensor data type." << std::endl;
+			return false;
+		}
+
+		const int64_t sample_size = std::accumulate(sample_shape.begin(), sample_shape.end(), int64_t(1), std::multiplies<int64_t>());
+		if (sample_size != static_cast<int64_t>(column.GetSampleSize()))
+		{
+			std::cerr << "Training data of '" << column.mName << "' does not have the tensor sample shape." << std::endl;
+			return false;
+		}
+
+		std::vector<int64_t> shape = { static_cast<int64_t>(column.mCount) };
+		shape.insert(shape.end(), sample_shape.begin(), sample_shape.end());
+
+		TF_Tensor* tensor = TF_AllocateTensor(dtype, shape.data(), static_cast<int>(shape.size()), column.GetByteSize());
+		if (column.GetByteSize() > 0)
+			std::memcpy(TF_TensorData(tensor), column.GetData(), column.GetByteSize());
+
+		output = cppflow::tensor(tensor);
+		return true;
+	}
+
+	template <typename T>
+	static bool AppendTypedTensorToColumn(const TF_Tensor* tensor,
+										  uint64_t sample_count,
+										  const std::vector<int64_t>& sample_shape,
+										  TrainingColumn& column)
+	{
+		const std::span<const T> values(static_cast<const T*>(TF_TensorData(tensor)), TF_TensorByteSize(tensor) / sizeof(T));
+		return column.Append(values, sample_count, sample_shape);
+	}
+
+	bool AppendTensorToColumn(const cppflow::tensor& tensor,
+							  TrainingColumn& column)
+	{
+		const std::shared_ptr<TF_Tensor> tf_tensor = tensor.get_tensor();
+
+		const std::vector<int64_t> shape = GetTensorShape(tensor);
+		if (shape.empty())
+		{
+			std::cerr << "Training tensors require a batch dimension." << std::endl;
+			return false;
+		}
+
+		const uint64_t sample_count = static_cast<uint64_t>(shape.front());
+		const std::vector<int64_t> sample_shape(shape.begin() + 1, shape.end());
+
+		switch (TF_TensorType(tf_tensor.get()))
+		{
+		case TF_FLOAT:
+			return AppendTypedTensorToColumn<float>(tf_tensor.get(), sample_count, sample_shape, column);
+		case TF_DOUBLE:
+			return AppendTypedTensorToColumn<double>(tf_tensor.get(), sample_count, sample_shape, column);
+		case TF_INT32:
+			return AppendTypedTensorToColumn<int32_t>(tf_tensor.get(), sample_count, sample_shape, column);
+		case TF_INT64:
+			return AppendTypedTensorToColumn<int64_t>(tf_tensor.get(), sample_count, sample_shape, column);
+		case TF_UINT8:
+		case TF_BOOL:
+			return AppendTypedTensorToColumn<uint8_t>(tf_tensor.get(), sample_count, sample_shape, column);
+		default:
+			std::cerr << "Unsupported Tensor Type For Training Data." << std::endl;
+			return false;
+		}
+	}
+}
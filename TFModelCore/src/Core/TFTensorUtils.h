@@ -0,0 +1,111 @@
+#pragma once
+
+#include "CppFlowLib.h"
+#include "Core/TFModelLayout.h"
+#include "Core/TFTrainingBatch.h"
+
+#include <string>
+#include <vector>
+
+namespace TF
+{
+	/// <summary>
+	/// Utility function to retrieve the shape of a tensor without copying its data.
+	/// </summary>
+	/// <param name="tensor">The input tensor</param>
+	/// <returns>The dimensions of the tensor</returns>
+	std::vector<int64_t> GetTensorShape(const cppflow::tensor& tensor);
+
+	/// <summary>
+	/// Utility function to convert a layout data type to its TensorFlow data type.
+	/// </summary>
+	/// <param name="type">The layout data type</param>
+	/// <returns>The TensorFlow data type</returns>
+	TF_DataType ToTFDataType(DataType type);
+
+	/// <summary>
+	/// Utility function to create a zero filled tensor.
+	/// </summary>
+	/// <param name="dtype">The data type of the tensor</param>
+	/// <param name="shape">The shape of the tensor</param>
+	/// <returns>The created tensor</returns>
+	cppflow::tensor CreateZeroTensor(TF_DataType dtype,
+									 const std::vector<int64_t>& shape);
+
+	/// <summary>
+	/// Utility function to create a string tensor.
+	/// </summary>
+	/// <param name="values">The string values, in row-major order</param>
+	/// <param name="shape">The shape of the tensor</param>
+	/// <returns>The created tensor</returns>
+	cppflow::tensor CreateStringTensor(const std::vector<std::string>& values,
+									   const std::vector<int64_t>& shape);
+
+	/// <summary>
+	/// Utility function to append the data type, shape and contents of a tensor to a byte string,
+	/// so tensors can be hashed and compared as a whole.
+	/// </summary>
+	/// <param name="tensor">The input tensor</param>
+	/// <param name="bytes">The byte string to append to</param>
+	void AppendTensorBytes(const cppflow::tensor& tensor,
+						   std::string& bytes);
+
+	/// <summary>
+	/// Utility function to concatenate tensors along their first (batch) dimension.
+	/// All tensors must share the same data type and non-batch dimensions.
+	/// </summary>
+	/// <param name="tensors">The input tensors</param>
+	/// <param name="output">The stacked tensor</param>
+	/// <returns>True if the tensors could be stacked</returns>
+	bool StackTensors(const std::vector<cppflow::tensor>& tensors,
+					  cppflow::tensor& output);
+
+	/// <summary>
+	/// Utility function to copy a range of rows along the first (batch) dimension of a tensor.
+	/// </summary>
+	/// <param name="tensor">The input tensor</param>
+	/// <param name="begin">The first row</param>
+	/// <param name="count">The number of rows</param>
+	/// <param name="output">The sliced tensor</param>
+	/// <returns>True if the range is valid</returns>
+	bool SliceTensor(const cppflow::tensor& tensor,
+					 int64_t begin,
+					 int64_t count,
+					 cppflow::tensor& output);
+
+	/// <summary>
+	/// Utility function to copy rows along the first (batch) dimension of a tensor, in the given order.
+	/// </summary>
+	/// <param name="tensor">The input tensor</param>
+	/// <param name="rows">The row indices</param>
+	/// <param name="count">The number of rows</param>
+	/// <param name="output">The gathered tensor</param>
+	/// <returns>True if every row index is valid</returns>
+	bool GatherTensorRows(const cppflow::tensor& tensor,
+						  const int64_t* rows,
+						  size_t count,
+						  cppflow::tensor& output);
+
+	/// <summary>
+	/// Utility function to create a tensor holding every sample of a training column.
+	/// </summary>
+	/// <param name="column">The training column</param>
+	/// <param name="dtype">The data type of the tensor, which must match the column</param>
+	/// <param name="sample_shape">The shape of a single row, holding as many elements as a sample</param>
+	/// <param name="output">The created tensor</param>
+	/// <returns>True if the column matches the data type and sample shape</returns>
+	bool CreateTensorFromColumn(const TrainingColumn& column,
+								TF_DataType dtype,
+								const std::vector<int64_t>& sample_shape,
+								cppflow::tensor& output);
+
+	/// <summary>
+	/// Utility function to append the rows of a tensor to a training column, with a single copy
+	/// when the tensor has the column data type.
+	/// </summary>
+	/// <param name="tensor">The tensor, batched along the first dimension</param>
+	/// <param name="column">The training column</param>
+	/// <returns>True if the rows match the column sample shape</returns>
+	bool AppendTensorToColumn(const cppflow::tensor& tensor,
+							  TrainingColumn& column);
+}
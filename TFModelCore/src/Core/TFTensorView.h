@@ -0,0 +1,91 @@
+#pragma once
+
+#include "CppFlowLib.h"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace TF
+{
+	/// <summary>
+	/// Utility function to retrieve the TensorFlow data type matching a C++ type.
+	/// </summary>
+	/// <typeparam name="T">The C++ data type</typeparam>
+	/// <returns>The TensorFlow data type</returns>
+	template<typename T>
+	constexpr TF_DataType GetTFDataType()
+	{
+		if constexpr (std::is_same_v<T, float>)
+			return TF_FLOAT;
+		else if constexpr (std::is_same_v<T, double>)
+			return TF_DOUBLE;
+		else if constexpr (std::is_same_v<T, int32_t>)
+			return TF_INT32;
+		else if constexpr (std::is_same_v<T, int64_t>)
+			return TF_INT64;
+		else if constexpr (std::is_same_v<T, uint8_t>)
+			return TF_UINT8;
+		else if constexpr (std::is_same_v<T, bool>)
+			return TF_BOOL;
+		else
+			static_assert(!sizeof(T), "Unsupported Tensor Data Type");
+	}
+
+	/// <summary>
+	/// Class representing a typed, read-only view over the buffer of a tensor.
+	/// The view keeps the underlying tensor alive, so no data is copied.
+	/// </summary>
+	/// <typeparam name="T">The data type of the tensor</typeparam>
+	template<typename T>
+	class TensorView
+	{
+	public:
+		/// <summary>
+		/// Constructor initializing a TensorView over the given tensor.
+		/// Throws if the tensor's data type does not match the view type.
+		/// </summary>
+		/// <param name="tensor">The viewed tensor</param>
+		TensorView(const cppflow::tensor& tensor)
+			: mpTensor(tensor.get_tensor())
+		{
+			if (TF_TensorType(mpTensor.get()) != GetTFDataType<T>())
+				throw std::invalid_argument("Tensor Data Type does not match the View Type.");
+
+			mData = std::span<const T>(static_cast<const T*>(TF_TensorData(mpTensor.get())),
+									   TF_TensorByteSize(mpTensor.get()) / sizeof(T));
+		}
+	public:
+		/// <summary>
+		/// Retrieves the viewed data.
+		/// </summary>
+		/// <returns>The span over the tensor buffer</returns>
+		std::span<const T> Data() const { return mData; }
+
+		/// <summary>
+		/// Retrieves the shape of the viewed tensor.
+		/// </summary>
+		/// <returns>The dimensions of the tensor</returns>
+		std::vector<int64_t> GetShape() const
+		{
+			std::vector<int64_t> shape(TF_NumDims(mpTensor.get()));
+			for (int i = 0; i < static_cast<int>(shape.size()); ++i)
+				shape[i] = TF_Dim(mpTensor.get(), i);
+			return shape;
+		}
+
+		size_t size() const { return mData.size(); }
+		bool empty() const { return mData.empty(); }
+
+		const T& operator[](size_t index) const { return mData[index]; }
+
+		auto begin() const { return mData.begin(); }
+		auto end() const { return mData.end(); }
+	private:
+		std::shared_ptr<TF_Tensor> mpTensor = nullptr;
+		std::span<const T> mData;
+	};
+}
@@ -0,0 +1,614 @@
+#include "Core/TFTrainer.h"
+#include "Core/TFTensorUtils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+namespace TF
+{
+	// Keras defaults of the supported optimizers and losses
+	static constexpr float AdamBeta1	= 0.9f;
+	static constexpr float AdamBeta2	= 0.999f;
+	static constexpr float AdamEpsilon	= 1e-7f;
+	static constexpr float LossEpsilon	= 1e-7f;
+
+	static cppflow::tensor CreateScalarTensor(float value)
+	{
+		TF_Tensor* tensor = TF_AllocateTensor(TF_FLOAT, nullptr, 0, sizeof(float));
+		std::memcpy(TF_TensorData(tensor), &value, sizeof(float));
+		return cppflow::tensor(tensor);
+	}
+
+	static std::vector<int32_t> GetAxes(int begin,
+										int end)
+	{
+		std::vector<int32_t> axes(std::max(0, end - begin));
+		std::iota(axes.begin(), axes.end(), begin);
+		return axes;
+	}
+
+	Trainer::Trainer(std::shared_ptr<Session> session,
+					 const GraphTrainingInfo& info,
+					 const std::vector<std::string>& output_names,
+					 const TrainingConfig& config)
+		: mpSession(std::move(session)),
+		mTrainingInfo(info),
+		mOutputNames(output_names),
+		mOptimizer(config.optimizer),
+		mLossFunction(config.loss_function),
+		mBuilder(mpSession->GetGraph()),
+		mRandom(std::random_device{}())
+	{
+		TF_Graph* graph = mpSession->GetGraph().get();
+
+		if (mOptimizer != "adam" && mOptimizer != "sgd")
+			throw std::invalid_argument("Unsupported Optimizer For Native Training: " + mOptimizer);
+
+		// Every trainer of the graph adds its own operations
+		std::string scope = "train";
+		for (int i = 1; TF_GraphOperationByName(graph, (scope + "/loss").c_str()); ++i)
+			scope = "train_" + std::to_string(i);
+
+		// Losses of each output, summed like Keras does for multiple outputs
+		std::vector<TF_Output> losses;
+		for (size_t i = 0; i < mOutputNames.size(); ++i)
+		{
+			TF_Output prediction;
+			TF_DataType dtype;
+			std::vector<int64_t> shape;
+			if (!mpSession->ResolveOutput(mOutputNames[i], prediction) || !mpSession->GetTensorSpec(mOutputNames[i], dtype, shape) || shape.empty())
+				throw std::runtime_error("Output '" + mOutputNames[i] + "' has no known rank for native training.");
+
+			const std::string output_scope = scope + "/output_" + std::to_string(i);
+			if (dtype != TF_FLOAT)
+			{
+				prediction = mBuilder.AddOp("Cast", output_scope + "/Cast", { prediction }, [](TF_OperationDescription* desc)
+				{
+					TF_SetAttrType(desc, "DstT", TF_FLOAT);
+				});
+			}
+
+			shape.front() = -1;
+			const TF_Output label = mBuilder.AddOp("Placeholder", output_scope + "/labels", {}, [&](TF_OperationDescription* desc)
+			{
+				TF_SetAttrType(desc, "dtype", TF_FLOAT);
+				TF_SetAttrShape(desc, "shape", shape.data(), static_cast<int>(shape.size()));
+			});
+
+			mLabels.push_back(label);
+			losses.push_back(AddLoss(output_scope, prediction, label, static_cast<int>(shape.size())));
+		}
+
+		TF_Output total_loss = losses.empty() ? TF_Output{} : losses.front();
+		for (size_t i = 1; i < losses.size(); ++i)
+			total_loss = mBuilder.AddOp("AddV2", scope + "/total_loss_" + std::to_string(i), { total_loss, losses[i] });
+
+		mLoss = mBuilder.AddOp("Identity", scope + "/loss", { total_loss });
+
+		// Scalar inputs of the optimizer
+		const auto add_scalar_input = [&](const std::string& name)
+		{
+			return mBuilder.AddOp("Placeholder", scope + "/" + name, {}, [](TF_OperationDescription* desc)
+			{
+				TF_SetAttrType(desc, "dtype", TF_FLOAT);
+				TF_SetAttrShape(desc, "shape", nullptr, 0);
+			});
+		};
+
+		mLearningRate = add_scalar_input("learning_rate");
+		if (mOptimizer == "adam")
+		{
+			mBeta1Power = add_scalar_input("beta1_power");
+			mBeta2Power = add_scalar_input("beta2_power");
+		}
+
+		if (!mBuilder.GetError().empty())
+			throw std::runtime_error("Failed to Add Training Operations: " + mBuilder.GetError());
+
+		// Gradients of the loss with respect to the value read from each trainable variable
+		std::vector<const GraphVariableInfo*> trainable;
+		std::vector<TF_Output> values;
+		for (const GraphVariableInfo& variable : mTrainingInfo.mVariables)
+		{
+			TF_Output value;
+			if (!variable.mTrainable || !mpSession->ResolveOutput(variable.mValue, value))
+				continue;
+
+			trainable.push_back(&variable);
+			values.push_back(value);
+		}
+
+		if (values.empty())
+			throw std::runtime_error("Graph has no trainable variables.");
+
+		std::vector<TF_Output> gradients(values.size());
+		std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)> status(TF_NewStatus(), TF_DeleteStatus);
+		TF_AddGradients(graph, &mLoss, 1, values.data(), static_cast<int>(values.size()), nullptr, status.get(), gradients.data());
+		if (TF_GetCode(status.get()) != TF_OK)
+			throw std::runtime_error(std::string("Failed to Add Gradients: ") + TF_Message(status.get()));
+
+		for (size_t i = 0; i < trainable.size(); ++i)
+		{
+			// Variables not contributing to the loss have no gradient
+			if (!gradients[i].oper)
+				continue;
+
+			if (TF_Operation* update = AddOptimizerUpdate(scope + "/" + trainable[i]->mName, *trainable[i], gradients[i]))
+				mTrainOps.push_back(update);
+		}
+
+		for (const std::string& name : mTrainingInfo.mUpdateOps)
+		{
+			if (const TF_Operation* op = TF_GraphOperationByName(graph, name.c_str()))
+				mTrainOps.push_back(op);
+		}
+
+		if (!mTrainingInfo.mTrainingFlag.empty())
+			mpSession->ResolveOutput(mTrainingInfo.mTrainingFlag, mTrainingFlag);
+
+		if (!mBuilder.GetError().empty())
+			throw std::runtime_error("Failed to Add Optimizer Operations: " + mBuilder.GetError());
+
+		// The optimizer slots start from zero, the model variables keep their loaded values
+		if (!mBuilder.InitializeVariables(*mpSession))
+			throw std::runtime_error("Failed to Initialize Optimizer Variables.");
+	}
+
+	bool Trainer::Train(const std::vector<std::tuple<std::string, cppflow::tensor>>& inputs,
+						const std::vector<cppflow::tensor>& labels,
+						const TrainingConfig& config,
+						const TrainingCallback& on_epoch,
+						const std::atomic<bool>* cancelled,
+						uint32_t initial_epoch)
+	{
+		if (inputs.empty() || labels.size() != mLabels.size())
+		{
+			std::cerr << "Missing Inputs Or Labels For Native Training." << std::endl;
+			return false;
+		}
+
+		std::vector<TF_Output> feeds;
+		std::vector<cppflow::tensor> tensors;
+		for (const auto& [name, tensor] : inputs)
+		{
+			TF_Output input;
+			if (!mpSession->ResolveOutput(name, input))
+			{
+				std::cerr << "Input operation '" << name << "' not found in graph." << std::endl;
+				return false;
+			}
+
+			feeds.push_back(input);
+			tensors.push_back(tensor);
+		}
+
+		feeds.insert(feeds.end(), mLabels.begin(), mLabels.end());
+		tensors.insert(tensors.end(), labels.begin(), labels.end());
+
+		const std::vector<int64_t> first_shape = GetTensorShape(tensors.front());
+		const int64_t sample_count = first_shape.empty() ? 0 : first_shape.front();
+		for (const cppflow::tensor& tensor : tensors)
+		{
+			const std::vector<int64_t> shape = GetTensorShape(tensor);
+			if (shape.empty() || shape.front() != sample_count)
+			{
+				std::cerr << "Mismatched Sample Counts For Native Training." << std::endl;
+				return false;
+			}
+		}
+
+		if (sample_count <= 0)
+			return false;
+
+		const int64_t batch_size = std::max<int64_t>(1, config.batch_size);
+
+		// Like Keras, the validation samples are the last ones, split before shuffling
+		const int64_t validation_count = std::clamp<int64_t>(static_cast<int64_t>(sample_count * std::max(0.0f, config.validation_split)), 0, sample_count - 1);
+		const int64_t train_count = sample_count - validation_count;
+
+		std::vector<int64_t> order(static_cast<size_t>(train_count));
+		std::iota(order.begin(), order.end(), 0);
+
+		std::vector<int64_t> validation_rows(static_cast<size_t>(validation_count));
+		std::iota(validation_rows.begin(), validation_rows.end(), train_count);
+
+		float best_loss = std::numeric_limits<float>::infinity();
+		uint32_t epochs_without_improvement = 0;
+		std::vector<cppflow::tensor> best_weights;
+
+		std::vector<cppflow::tensor> batch(tensors.size());
+		for (uint32_t epoch = initial_epoch; epoch < config.epochs; ++epoch)
+		{
+			if (config.shuffle)
+				std::shuffle(order.begin(), order.end(), mRandom);
+
+			const auto start = std::chrono::steady_clock::now();
+
+			double loss_sum = 0.0;
+			for (int64_t begin = 0; begin < train_count; begin += batch_size)
+			{
+				if (cancelled && cancelled->load(std::memory_order_relaxed))
+				{
+					std::cout << "Training Cancelled." << std::endl;
+					return false;
+				}
+
+				const int64_t count = std::min(batch_size, train_count - begin);
+				for (size_t i = 0; i < tensors.size(); ++i)
+				{
+					if (!GatherTensorRows(tensors[i], order.data() + begin, static_cast<size_t>(count), batch[i]))
+						return false;
+				}
+
+				float loss = 0.0f;
+				if (!RunStep(feeds, batch, config.learning_rate, loss))
+					return false;
+
+				loss_sum += static_cast<double>(loss) * count;
+			}
+
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			TrainingProgress progress;
+			progress.mEpoch = epoch + 1;
+			progress.mEpochs = config.epochs;
+			progress.mLoss = static_cast<float>(loss_sum / train_count);
+			progress.mSamplesPerSecond = seconds > 0.0 ? train_count / seconds : 0.0;
+
+			if (validation_count > 0 && !Evaluate(feeds, tensors, validation_rows, batch_size, progress.mValidationLoss))
+				return false;
+
+			std::cout << "Epoch " << progress.mEpoch << "/" << progress.mEpochs
+					  << " - loss: " << progress.mLoss;
+			if (validation_count > 0)
+				std::cout << " - val_loss: " << progress.mValidationLoss;
+			std::cout << " - " << progress.mSamplesPerSecond << " samples/sec" << std::endl;
+
+			if (on_epoch)
+				on_epoch(progress);
+
+			if (!config.early_stopping)
+				continue;
+
+			const float monitored = validation_count > 0 ? progress.mValidationLoss : progress.mLoss;
+			if (monitored < best_loss)
+			{
+				best_loss = monitored;
+				epochs_without_improvement = 0;
+				if (!ReadVariables(mTrainingInfo, *mpSession, best_weights))
+					return false;
+			}
+			else if (++epochs_without_improvement >= std::max(1u, config.early_stopping_patience))
+			{
+				std::cout << "Early Stopping At Epoch " << progress.mEpoch << ", Restoring The Best Weights." << std::endl;
+				return best_weights.empty() || AssignVariables(mTrainingInfo, *mpSession, best_weights);
+			}
+		}
+
+		return true;
+	}
+
+	bool Trainer::Save(const std::filesystem::path& source_dir,
+					   const std::filesystem::path& export_dir) const
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(export_dir / "variables", ec);
+
+		for (const char* filename : { "saved_model.pb", GraphTrainingInfo::Filename })
+		{
+			std::filesystem::copy_file(source_dir / filename, export_dir / filename, std::filesystem::copy_options::overwrite_existing, ec);
+			if (ec)
+			{
+				std::cerr << "Failed to Copy {" << (source_dir / filename) << "}: " << ec.message() << std::endl;
+				return false;
+			}
+		}
+
+		TF_Output prefix_input;
+		TF_Output save_tensor;
+		if (!mpSession->ResolveOutput(mTrainingInfo.mSaveFilename, prefix_input) || !mpSession->ResolveOutput(mTrainingInfo.mSaveTensor, save_tensor))
+		{
+			std::cerr << "Graph has no checkpoint operations." << std::endl;
+			return false;
+		}
+
+		const cppflow::tensor prefix = CreateStringTensor({ (export_dir / "variables" / "variables").string() }, {});
+		TF_Tensor* prefix_value = prefix.get_tensor().get();
+
+		const TF_Operation* save_op = save_tensor.oper;
+		if (!mpSession->Run(&prefix_input, &prefix_value, 1, nullptr, nullptr, 0, &save_op, 1))
+		{
+			std::cerr << "Failed to Save Variables {" << export_dir << "}" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	std::shared_ptr<Session> Trainer::CreateServingSession(const SessionConfig& config) const
+	{
+		std::shared_ptr<Session> session = nullptr;
+		try
+		{
+			session = std::make_shared<Session>(mpSession->GetGraph(), mpSession->GetSignatures(), config);
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what() << std::endl;
+			return nullptr;
+		}
+
+		// Copy the model variables, the optimizer slots are only used by the training session
+		if (!CopyVariables(mTrainingInfo, *mpSession, *session))
+			return nullptr;
+
+		return session;
+	}
+
+	bool Trainer::RestoreWeights(const Session& source)
+	{
+		return CopyVariables(mTrainingInfo, source, *mpSession);
+	}
+
+	bool Trainer::CopyVariables(const GraphTrainingInfo& info,
+								const Session& source,
+								const Session& target)
+	{
+		std::vector<cppflow::tensor> weights;
+		return ReadVariables(info, source, weights) && AssignVariables(info, target, weights);
+	}
+
+	bool Trainer::ReadVariables(const GraphTrainingInfo& info,
+								const Session& session,
+								std::vector<cppflow::tensor>& weights)
+	{
+		std::vector<TF_Output> values(info.mVariables.size());
+		for (size_t i = 0; i < info.mVariables.size(); ++i)
+		{
+			if (!session.ResolveOutput(info.mVariables[i].mValue, values[i]))
+			{
+				std::cerr << "Variable '" << info.mVariables[i].mName << "' not found in graph." << std::endl;
+				return false;
+			}
+		}
+
+		std::vector<TF_Tensor*> outputs(values.size(), nullptr);
+		if (!session.Run(nullptr, nullptr, 0, values.data(), outputs.data(), static_cast<int>(values.size())))
+			return false;
+
+		weights.assign(outputs.begin(), outputs.end());
+		return true;
+	}
+
+	bool Trainer::AssignVariables(const GraphTrainingInfo& info,
+								  const Session& session,
+								  const std::vector<cppflow::tensor>& weights)
+	{
+		if (weights.size() != info.mVariables.size())
+			return false;
+
+		std::vector<TF_Output> assign_inputs(info.mVariables.size());
+		std::vector<const TF_Operation*> initializers(info.mVariables.size());
+		for (size_t i = 0; i < info.mVariables.size(); ++i)
+		{
+			const GraphVariableInfo& variable = info.mVariables[i];
+			initializers[i] = TF_GraphOperationByName(session.GetGraph().get(), variable.mInitializer.c_str());
+			if (!session.ResolveOutput(variable.mInitialValue, assign_inputs[i]) || !initializers[i])
+			{
+				std::cerr << "Variable '" << variable.mName << "' not found in graph." << std::endl;
+				return false;
+			}
+		}
+
+		std::vector<std::shared_ptr<TF_Tensor>> owners(weights.size());
+		std::vector<TF_Tensor*> values(weights.size());
+		for (size_t i = 0; i < weights.size(); ++i)
+		{
+			owners[i] = weights[i].get_tensor();
+			values[i] = owners[i].get();
+		}
+
+		return session.Run(assign_inputs.data(), values.data(), static_cast<int>(assign_inputs.size()),
+						   nullptr, nullptr, 0,
+						   initializers.data(), static_cast<int>(initializers.size()));
+	}
+
+	bool Trainer::IsCompatible(const TrainingConfig& config) const
+	{
+		return config.optimizer == mOptimizer && config.loss_function == mLossFunction;
+	}
+
+	TF_Output Trainer::AddLoss(const std::string& scope,
+							   TF_Output prediction,
+							   TF_Output label,
+							   int rank)
+	{
+		const TF_Output all_axes = mBuilder.AddInt32Const(scope + "/axes", GetAxes(0, rank));
+
+		const auto clip = [&](TF_Output x)
+		{
+			const TF_Output lower = mBuilder.AddOp("Maximum", scope + "/clip/Maximum", { x, mBuilder.AddFloatConst(scope + "/clip/epsilon", LossEpsilon) });
+			return mBuilder.AddOp("Minimum", scope + "/clip/Minimum", { lower, mBuilder.AddFloatConst(scope + "/clip/one_minus_epsilon", 1.0f - LossEpsilon) });
+		};
+
+		if (mLossFunction == "categorical_crossentropy")
+		{
+			if (rank < 2)
+			{
+				mBuilder.Fail("Categorical crossentropy requires outputs with a class dimension.");
+				return {};
+			}
+
+			// Like Keras, probabilities are renormalized over the classes and clipped
+			const TF_Output class_axis = mBuilder.AddInt32Const(scope + "/class_axis", { rank - 1 });
+			const TF_Output sum = mBuilder.AddOp("Sum", scope + "/Sum", { prediction, class_axis }, [](TF_OperationDescription* desc)
+			{
+				TF_SetAttrBool(desc, "keep_dims", 1);
+			});
+
+			const TF_Output probabilities = clip(mBuilder.AddOp("RealDiv", scope + "/truediv", { prediction, sum }));
+			const TF_Output log_likelihood = mBuilder.AddOp("Mul", scope + "/mul", { label, mBuilder.AddOp("Log", scope + "/Log", { probabilities }) });
+			const TF_Output crossentropy = mBuilder.AddOp("Neg", scope + "/Neg", { mBuilder.AddOp("Sum", scope + "/Sum_1", { log_likelihood, class_axis }) });
+
+			return mBuilder.AddOp("Mean", scope + "/loss", { crossentropy, mBuilder.AddInt32Const(scope + "/sample_axes", GetAxes(0, rank - 1)) });
+		}
+
+		if (mLossFunction == "binary_crossentropy")
+		{
+			const TF_Output one = mBuilder.AddFloatConst(scope + "/one", 1.0f);
+			const TF_Output probabilities = clip(prediction);
+
+			const TF_Output positive = mBuilder.AddOp("Mul", scope + "/positive", { label, mBuilder.AddOp("Log", scope + "/Log", { probabilities }) });
+			const TF_Output negative = mBuilder.AddOp("Mul", scope + "/negative",
+			{
+				mBuilder.AddOp("Sub", scope + "/sub", { one, label }),
+				mBuilder.AddOp("Log", scope + "/Log_1", { mBuilder.AddOp("Sub", scope + "/sub_1", { one, probabilities }) })
+			});
+
+			const TF_Output crossentropy = mBuilder.AddOp("Neg", scope + "/Neg", { mBuilder.AddOp("AddV2", scope + "/add", { positive, negative }) });
+			return mBuilder.AddOp("Mean", scope + "/loss", { crossentropy, all_axes });
+		}
+
+		const TF_Output error = mBuilder.AddOp("Sub", scope + "/sub", { prediction, label });
+		if (mLossFunction == "mse" || mLossFunction == "mean_squared_error")
+			return mBuilder.AddOp("Mean", scope + "/loss", { mBuilder.AddOp("Square", scope + "/Square", { error }), all_axes });
+
+		if (mLossFunction == "mae" || mLossFunction == "mean_absolute_error")
+			return mBuilder.AddOp("Mean", scope + "/loss", { mBuilder.AddOp("Abs", scope + "/Abs", { error }), all_axes });
+
+		mBuilder.Fail("Unsupported Loss Function For Native Training: " + mLossFunction);
+		return {};
+	}
+
+	TF_Operation* Trainer::AddOptimizerUpdate(const std::string& scope,
+											  const GraphVariableInfo& variable,
+											  TF_Output gradient)
+	{
+		TF_Output value;
+		mpSession->ResolveOutput(variable.mValue, value);
+
+		// The value is read from the variable handle
+		const TF_Output handle = TF_OperationInput({ value.oper, 0 });
+		const auto set_type = [](TF_OperationDescription* desc) { TF_SetAttrType(desc, "T", TF_FLOAT); };
+
+		if (mOptimizer == "sgd")
+			return mBuilder.AddOp("ResourceApplyGradientDescent", scope + "/ApplyGradientDescent", { handle, mLearningRate, gradient }, set_type).oper;
+
+		const std::vector<int64_t> shape = mBuilder.GetShape(value);
+		size_t size = 1;
+		for (int64_t dim : shape)
+			size *= static_cast<size_t>(std::max<int64_t>(0, dim));
+
+		mBuilder.AddVariable(scope + "/m", shape, std::vector<float>(size, 0.0f), false);
+		const TF_Output m = mBuilder.GetVariables().back().mHandle;
+		mBuilder.AddVariable(scope + "/v", shape, std::vector<float>(size, 0.0f), false);
+		const TF_Output v = mBuilder.GetVariables().back().mHandle;
+
+		return mBuilder.AddOp("ResourceApplyAdam", scope + "/ApplyAdam",
+		{
+			handle, m, v,
+			mBeta1Power, mBeta2Power, mLearningRate,
+			mBuilder.AddFloatConst(scope + "/beta1", AdamBeta1),
+			mBuilder.AddFloatConst(scope + "/beta2", AdamBeta2),
+			mBuilder.AddFloatConst(scope + "/epsilon", AdamEpsilon),
+			gradient
+		}, set_type).oper;
+	}
+
+	bool Trainer::RunStep(const std::vector<TF_Output>& inputs,
+						  const std::vector<cppflow::tensor>& values,
+						  float learning_rate,
+						  float& loss)
+	{
+		std::vector<TF_Output> feeds = inputs;
+		std::vector<cppflow::tensor> tensors = values;
+
+		feeds.push_back(mLearningRate);
+		tensors.push_back(CreateScalarTensor(learning_rate));
+
+		if (mTrainingFlag.oper)
+		{
+			feeds.push_back(mTrainingFlag);
+			tensors.push_back(CreateScalarTensor(1.0f));
+		}
+
+		if (mBeta1Power.oper)
+		{
+			const double step = static_cast<double>(mStep + 1);
+			feeds.push_back(mBeta1Power);
+			tensors.push_back(CreateScalarTensor(static_cast<float>(std::pow(AdamBeta1, step))));
+			feeds.push_back(mBeta2Power);
+			tensors.push_back(CreateScalarTensor(static_cast<float>(std::pow(AdamBeta2, step))));
+		}
+
+		if (!RunLoss(feeds, tensors, mTrainOps, loss))
+			return false;
+
+		++mStep;
+		return true;
+	}
+
+	bool Trainer::Evaluate(const std::vector<TF_Output>& inputs,
+						   const std::vector<cppflow::tensor>& tensors,
+						   const std::vector<int64_t>& rows,
+						   int64_t batch_size,
+						   float& loss)
+	{
+		const int64_t row_count = static_cast<int64_t>(rows.size());
+		if (row_count == 0)
+			return false;
+
+		// The training flag keeps its default, evaluating dropout and batch normalization in inference mode
+		double loss_sum = 0.0;
+		std::vector<cppflow::tensor> batch(tensors.size());
+		for (int64_t begin = 0; begin < row_count; begin += batch_size)
+		{
+			const int64_t count = std::min(batch_size, row_count - begin);
+			for (size_t i = 0; i < tensors.size(); ++i)
+			{
+				if (!GatherTensorRows(tensors[i], rows.data() + begin, static_cast<size_t>(count), batch[i]))
+					return false;
+			}
+
+			float batch_loss = 0.0f;
+			if (!RunLoss(inputs, batch, {}, batch_loss))
+				return false;
+
+			loss_sum += static_cast<double>(batch_loss) * count;
+		}
+
+		loss = static_cast<float>(loss_sum / row_count);
+		return true;
+	}
+
+	bool Trainer::RunLoss(const std::vector<TF_Output>& inputs,
+						  const std::vector<cppflow::tensor>& values,
+						  const std::vector<const TF_Operation*>& targets,
+						  float& loss) const
+	{
+		// Keep the resolved tensors alive for the duration of the run
+		std::vector<std::shared_ptr<TF_Tensor>> tf_tensors(values.size());
+		std::vector<TF_Tensor*> feed_values(values.size());
+		for (size_t i = 0; i < values.size(); ++i)
+		{
+			tf_tensors[i] = values[i].get_tensor();
+			feed_values[i] = tf_tensors[i].get();
+		}
+
+		TF_Tensor* loss_value = nullptr;
+		if (!mpSession->Run(inputs.data(), feed_values.data(), static_cast<int>(inputs.size()),
+							&mLoss, &loss_value, 1,
+							targets.data(), static_cast<int>(targets.size())))
+		{
+			return false;
+		}
+
+		const cppflow::tensor owner(loss_value);
+		loss = *static_cast<const float*>(TF_TensorData(loss_value));
+		return true;
+	}
+}
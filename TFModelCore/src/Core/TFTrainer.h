@@ -0,0 +1,220 @@
+#pragma once
+
+#include "CppFlowLib.h"
+#include "Core/TFGraphBuilder.h"
+#include "Core/TFSession.h"
+#include "Core/TFTrainingConfig.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace TF
+{
+	/// <summary>
+	/// Class training a natively built graph in-process through the C API.
+	///
+	/// The loss, gradient and optimizer operations are added to the graph of a dedicated
+	/// session, so the weights are updated in place across training calls and can be published
+	/// without saving or reloading the model.
+	/// </summary>
+	class Trainer
+	{
+	public:
+		/// <summary>
+		/// Constructor adding the training operations of the given outputs. Throws on failure.
+		/// </summary>
+		/// <param name="session">The session owning the trained variables</param>
+		/// <param name="info">The training info of the graph</param>
+		/// <param name="output_names">The graph tensor names of the trained outputs</param>
+		/// <param name="config">The training configuration selecting the optimizer and loss</param>
+		Trainer(std::shared_ptr<Session> session,
+				const GraphTrainingInfo& info,
+				const std::vector<std::string>& output_names,
+				const TrainingConfig& config);
+	public:
+		/// <summary>
+		/// Trains the graph on the given samples for the configured number of epochs. Like Keras,
+		/// the last validation_split of the samples are held out to compute the validation loss,
+		/// and early stopping restores the weights of the best epoch.
+		/// </summary>
+		/// <param name="inputs">The graph input names and tensors, batched along the first dimension</param>
+		/// <param name="labels">The labels of each trained output, batched along the first dimension</param>
+		/// <param name="config">The training configuration</param>
+		/// <param name="on_epoch">Optional callback receiving the progress after each epoch</param>
+		/// <param name="cancelled">Optional flag stopping the training after the current step</param>
+		/// <param name="initial_epoch">The number of epochs already trained, when resuming a training</param>
+		/// <returns>True if every training step was successful and the training was not cancelled</returns>
+		bool Train(const std::vector<std::tuple<std::string, cppflow::tensor>>& inputs,
+				   const std::vector<cppflow::tensor>& labels,
+				   const TrainingConfig& config,
+				   const TrainingCallback& on_epoch = nullptr,
+				   const std::atomic<bool>* cancelled = nullptr,
+				   uint32_t initial_epoch = 0);
+
+		/// <summary>
+		/// Replaces the trained weights by those of another session, e.g. to discard an incomplete training.
+		/// </summary>
+		/// <param name="source">A session of the same model, variables are matched by name</param>
+		/// <returns>True if every variable was copied</returns>
+		bool RestoreWeights(const Session& source);
+
+		/// <summary>
+		/// Writes the current weights as a SavedModel, reusing the graph of the SavedModel
+		/// the session was loaded from.
+		/// </summary>
+		/// <param name="source_dir">The SavedModel the session was loaded from</param>
+		/// <param name="export_dir">The SavedModel directory to write</param>
+		/// <returns>True if the SavedModel was written</returns>
+		bool Save(const std::filesystem::path& source_dir,
+				  const std::filesystem::path& export_dir) const;
+
+		/// <summary>
+		/// Creates a new session over the trained graph holding a copy of the current weights,
+		/// so further training does not affect it.
+		/// </summary>
+		/// <param name="config">The session configuration</param>
+		/// <returns>The session or nullptr on failure</returns>
+		std::shared_ptr<Session> CreateServingSession(const SessionConfig& config) const;
+
+		/// <summary>
+		/// Checks whether the trainer was built for the optimizer and loss of a configuration.
+		/// </summary>
+		/// <param name="config">The training configuration</param>
+		/// <returns>True if the configuration can be trained by this trainer</returns>
+		bool IsCompatible(const TrainingConfig& config) const;
+
+		std::shared_ptr<Session> GetSession() const { return mpSession; }
+		const GraphTrainingInfo& GetTrainingInfo() const { return mTrainingInfo; }
+		const std::vector<std::string>& GetOutputNames() const { return mOutputNames; }
+	private:
+		/// <summary>
+		/// Copies the model variables between two sessions of the same model.
+		/// </summary>
+		/// <param name="info">The training info naming the variables</param>
+		/// <param name="source">The session to read the variables from</param>
+		/// <param name="target">The session to assign the variables of</param>
+		/// <returns>True if every variable was copied</returns>
+		static bool CopyVariables(const GraphTrainingInfo& info,
+								  const Session& source,
+								  const Session& target);
+
+		/// <summary>
+		/// Reads the values of the model variables.
+		/// </summary>
+		/// <param name="info">The training info naming the variables</param>
+		/// <param name="session">The session to read the variables from</param>
+		/// <param name="weights">The variable values, in the order of the training info</param>
+		/// <returns>True if every variable was read</returns>
+		static bool ReadVariables(const GraphTrainingInfo& info,
+								  const Session& session,
+								  std::vector<cppflow::tensor>& weights);
+
+		/// <summary>
+		/// Assigns the values of the model variables.
+		/// </summary>
+		/// <param name="info">The training info naming the variables</param>
+		/// <param name="session">The session to assign the variables of</param>
+		/// <param name="weights">The variable values, in the order of the training info</param>
+		/// <returns>True if every variable was assigned</returns>
+		static bool AssignVariables(const GraphTrainingInfo& info,
+									const Session& session,
+									const std::vector<cppflow::tensor>& weights);
+
+		/// <summary>
+		/// Adds the loss of one output against its label placeholder.
+		/// </summary>
+		/// <param name="scope">The operation name scope</param>
+		/// <param name="prediction">The output tensor</param>
+		/// <param name="label">The label placeholder</param>
+		/// <param name="rank">The rank of the output</param>
+		/// <returns>The scalar loss</returns>
+		TF_Output AddLoss(const std::string& scope,
+						  TF_Output prediction,
+						  TF_Output label,
+						  int rank);
+
+		/// <summary>
+		/// Adds the optimizer update of a trainable variable.
+		/// </summary>
+		/// <param name="scope">The operation name scope</param>
+		/// <param name="variable">The variable</param>
+		/// <param name="gradient">The gradient of the loss with respect to the variable</param>
+		/// <returns>The update operation</returns>
+		TF_Operation* AddOptimizerUpdate(const std::string& scope,
+										 const GraphVariableInfo& variable,
+										 TF_Output gradient);
+
+		/// <summary>
+		/// Runs a single training step on a batch.
+		/// </summary>
+		/// <param name="inputs">The resolved graph inputs, label placeholders included</param>
+		/// <param name="values">The batch tensors of each input</param>
+		/// <param name="learning_rate">The learning rate of the step</param>
+		/// <param name="loss">The loss of the batch</param>
+		/// <returns>True if the step was successful</returns>
+		bool RunStep(const std::vector<TF_Output>& inputs,
+					 const std::vector<cppflow::tensor>& values,
+					 float learning_rate,
+					 float& loss);
+
+		/// <summary>
+		/// Computes the mean loss over the given samples in inference mode, without updating the weights.
+		/// </summary>
+		/// <param name="inputs">The resolved graph inputs, label placeholders included</param>
+		/// <param name="tensors">The tensors of each input</param>
+		/// <param name="rows">The evaluated samples</param>
+		/// <param name="batch_size">The number of samples per run</param>
+		/// <param name="loss">The mean loss</param>
+		/// <returns>True if every run was successful</returns>
+		bool Evaluate(const std::vector<TF_Output>& inputs,
+					  const std::vector<cppflow::tensor>& tensors,
+					  const std::vector<int64_t>& rows,
+					  int64_t batch_size,
+					  float& loss);
+
+		/// <summary>
+		/// Runs the graph on a batch, fetching the loss.
+		/// </summary>
+		/// <param name="inputs">The graph inputs</param>
+		/// <param name="values">The tensors of each input</param>
+		/// <param name="targets">The operations to run along</param>
+		/// <param name="loss">The loss of the batch</param>
+		/// <returns>True if the run was successful</returns>
+		bool RunLoss(const std::vector<TF_Output>& inputs,
+					 const std::vector<cppflow::tensor>& values,
+					 const std::vector<const TF_Operation*>& targets,
+					 float& loss) const;
+	private:
+		std::shared_ptr<Session> mpSession = nullptr;
+		GraphTrainingInfo mTrainingInfo;
+		std::vector<std::string> mOutputNames;
+
+		std::string mOptimizer;
+		std::string mLossFunction;
+
+		// Builds the training operations and owns the optimizer slot variables
+		GraphBuilder mBuilder;
+
+		std::vector<TF_Output> mLabels;
+		TF_Output mLoss = {};
+		TF_Output mTrainingFlag = {};
+
+		// Scalar inputs fed on every step
+		TF_Output mLearningRate = {};
+		TF_Output mBeta1Power = {};
+		TF_Output mBeta2Power = {};
+
+		std::vector<const TF_Operation*> mTrainOps;
+
+		// Number of optimizer steps run, continued across training calls
+		uint64_t mStep = 0;
+
+		std::mt19937_64 mRandom;
+	};
+}
@@ -1,9 +1,372 @@
 #include "Core/TFTrainingBatch.h"
 
+#include <algorithm>
+#include <bit>
+#include <cstring>
 #include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <span>
+#include <sstream>
+#include <type_traits>
 
 namespace TF
 {
+	static_assert(std::endian::native == std::endian::little, "Binary training files are written little-endian.");
+
+	static const char* GetBinaryDType(DataType type)
+	{
+		switch (type)
+		{
+		case DataType::Bool:
+			return "bool";
+		case DataType::UInt8:
+			return "uint8";
+		case DataType::Float32:
+			return "float32";
+		case DataType::Float64:
+		case DataType::Double:
+			return "float64";
+		case DataType::Int32:
+			return "int32";
+		case DataType::Int64:
+			return "int64";
+		default:
+			throw std::invalid_argument("Unsupported DataType");
+		}
+	}
+
+	// Shape of nested JSON arrays, following the first element of each level
+	static std::vector<int64_t> GetJsonShape(const nlohmann::json& value)
+	{
+		std::vector<int64_t> shape;
+		for (const nlohmann::json* element = &value; element->is_array(); element = &(*element)[0])
+		{
+			shape.push_back(static_cast<int64_t>(element->size()));
+			if (element->empty())
+				break;
+		}
+		return shape;
+	}
+
+	// Values are stored as Storage, so booleans take one byte like TF_BOOL
+	template <typename T, typename Storage = T>
+	static bool AppendJson(const nlohmann::json& value,
+						   std::vector<Storage>& data)
+	{
+		if (value.is_array())
+		{
+			for (const nlohmann::json& element : value)
+			{
+				if (!AppendJson<T, Storage>(element, data))
+					return false;
+			}
+			return true;
+		}
+
+		if (!value.is_number() && !value.is_boolean())
+			return false;
+
+		if constexpr (std::is_same_v<T, bool>)
+			data.push_back(static_cast<Storage>(value.is_boolean() ? value.get<bool>() : value.get<double>() != 0.0));
+		else
+			data.push_back(static_cast<Storage>(value.is_boolean() ? static_cast<T>(value.get<bool>()) : value.get<T>()));
+		return true;
+	}
+
+	template <typename T>
+	static void EnsureStorage(TrainingColumn::Storage& storage)
+	{
+		if (!std::holds_alternative<std::vector<T>>(storage))
+			storage = std::vector<T>();
+	}
+
+	bool TrainingColumn::Append(const nlohmann::json& values)
+	{
+		if (IsImage())
+		{
+			// Image inputs are lists of paths, the first of which is loaded
+			const nlohmann::json& path = values.is_array() && !values.empty() ? values[0] : values;
+			if (!path.is_string())
+				return false;
+
+			mPaths.push_back(path.get<std::string>());
+			++mCount;
+			return true;
+		}
+
+		Storage& storage = GetStorage();
+		const size_t offset = std::visit([](const auto& data) { return data.size(); }, storage);
+
+		bool appended = false;
+		switch (mType)
+		{
+		case DataType::Bool:
+			appended = AppendJson<bool, uint8_t>(values, std::get<std::vector<uint8_t>>(storage));
+			break;
+		case DataType::UInt8:
+			appended = AppendJson<uint8_t>(values, std::get<std::vector<uint8_t>>(storage));
+			break;
+		case DataType::Float32:
+			appended = AppendJson<float>(values, std::get<std::vector<float>>(storage));
+			break;
+		case DataType::Float64:
+		case DataType::Double:
+			appended = AppendJson<double>(values, std::get<std::vector<double>>(storage));
+			break;
+		case DataType::Int32:
+			appended = AppendJson<int32_t>(values, std::get<std::vector<int32_t>>(storage));
+			break;
+		case DataType::Int64:
+			appended = AppendJson<int64_t>(values, std::get<std::vector<int64_t>>(storage));
+			break;
+		}
+
+		const size_t element_count = std::visit([](const auto& data) { return data.size(); }, storage) - offset;
+		const std::vector<int64_t> shape = mShapeKnown ? mShape : GetJsonShape(values);
+		if (!appended || !CheckSamples(element_count, 1, shape))
+		{
+			std::visit([&](auto& data) { data.resize(offset); }, storage);
+			return false;
+		}
+
+		CommitSamples(1, shape);
+		return true;
+	}
+
+	bool TrainingColumn::Append(const TrainingColumn& other)
+	{
+		if (other.mType != mType || other.mDomain != mDomain)
+			return false;
+
+		// An empty column has no shape to check or adopt
+		if (other.mCount == 0)
+			return true;
+
+		if (IsImage())
+		{
+			mPaths.insert(mPaths.end(), other.mPaths.begin(), other.mPaths.end());
+			mCount += other.mCount;
+			return true;
+		}
+
+		if (mShapeKnown && other.mShape != mShape)
+			return false;
+
+		return std::visit([&](const auto& data)
+		{
+			using Element = typename std::decay_t<decltype(data)>::value_type;
+			return Append(std::span<const Element>(data), other.mCount, other.mShape);
+		}, other.mData);
+	}
+
+	void TrainingColumn::Truncate(uint64_t count)
+	{
+		if (count >= mCount)
+			return;
+
+		mCount = count;
+		if (IsImage())
+			mPaths.resize(static_cast<size_t>(count));
+		else
+			std::visit([&](auto& data) { data.resize(static_cast<size_t>(count) * GetSampleSize()); }, mData);
+	}
+
+	nlohmann::json TrainingColumn::GetSampleJson(uint64_t index) const
+	{
+		nlohmann::json sample = nlohmann::json::array();
+		if (IsImage())
+		{
+			sample.push_back(mPaths[static_cast<size_t>(index)]);
+			return sample;
+		}
+
+		const size_t sample_size = GetSampleSize();
+		const size_t begin = static_cast<size_t>(index) * sample_size;
+		std::visit([&](const auto& data)
+		{
+			for (size_t i = begin; i < begin + sample_size; ++i)
+			{
+				if (mType == DataType::Bool)
+					sample.push_back(data[i] != 0);
+				else
+					sample.push_back(data[i]);
+			}
+		}, mData);
+		return sample;
+	}
+
+	size_t TrainingColumn::GetSampleSize() const
+	{
+		return static_cast<size_t>(std::accumulate(mShape.begin(), mShape.end(), int64_t(1), std::multiplies<int64_t>()));
+	}
+
+	size_t TrainingColumn::GetElementSize() const
+	{
+		return std::visit([](const auto& data) { return sizeof(typename std::decay_t<decltype(data)>::value_type); }, mData);
+	}
+
+	const void* TrainingColumn::GetData() const
+	{
+		return std::visit([](const auto& data) { return static_cast<const void*>(data.data()); }, mData);
+	}
+
+	size_t TrainingColumn::GetByteSize() const
+	{
+		return std::visit([](const auto& data) { return data.size() * sizeof(typename std::decay_t<decltype(data)>::value_type); }, mData);
+	}
+
+	TrainingColumn::Storage& TrainingColumn::GetStorage()
+	{
+		switch (mType)
+		{
+		case DataType::Bool:
+		case DataType::UInt8:
+			EnsureStorage<uint8_t>(mData);
+			break;
+		case DataType::Float32:
+			EnsureStorage<float>(mData);
+			break;
+		case DataType::Float64:
+		case DataType::Double:
+			EnsureStorage<double>(mData);
+			break;
+		case DataType::Int32:
+			EnsureStorage<int32_t>(mData);
+			break;
+		case DataType::Int64:
+			EnsureStorage<int64_t>(mData);
+			break;
+		}
+		return mData;
+	}
+
+	bool TrainingColumn::CheckSamples(size_t element_count,
+									  uint64_t sample_count,
+									  const std::vector<int64_t>& sample_shape) const
+	{
+		const std::vector<int64_t>& shape = mShapeKnown ? mShape : sample_shape;
+		if (std::any_of(shape.begin(), shape.end(), [](int64_t dim) { return dim < 0; }))
+			return false;
+
+		const int64_t sample_size = std::accumulate(shape.begin(), shape.end(), int64_t(1), std::multiplies<int64_t>());
+		return static_cast<uint64_t>(element_count) == sample_count * static_cast<uint64_t>(sample_size);
+	}
+
+	void TrainingColumn::CommitSamples(uint64_t sample_count,
+									   const std::vector<int64_t>& sample_shape)
+	{
+		if (!mShapeKnown)
+		{
+			mShape = sample_shape;
+			mShapeKnown = true;
+		}
+		mCount += sample_count;
+	}
+
+	bool TrainingBatch::AddSample(const std::string& input_name,
+								  const nlohmann::json& input_values,
+								  const std::string& label_name,
+								  const nlohmann::json& label_values,
+								  const ModelLayout& layout)
+	{
+		return AddSamples(input_name, label_name, layout,
+						  [&](TrainingColumn& input) { return input.Append(input_values); },
+						  [&](TrainingColumn& label) { return label.Append(label_values); });
+	}
+
+	TrainingColumn& TrainingBatch::GetInputColumn(const std::string& name,
+												  const ModelLayout& layout,
+												  bool& created)
+	{
+		TrainingColumn& input = GetColumn(mInputs, name, created);
+		if (!created)
+			return input;
+
+		// The first dimension of the layout shape is the batch dimension
+		auto found = std::find_if(layout.mInputs.begin(), layout.mInputs.end(), [&](const Input& layout_input) { return layout_input.mName == name; });
+		if (found != layout.mInputs.end())
+		{
+			input.mType = found->mType;
+			input.mDomain = found->mDomain;
+			if (!found->mShape.empty())
+			{
+				input.mShape.assign(found->mShape.begin() + 1, found->mShape.end());
+				input.mShapeKnown = std::none_of(input.mShape.begin(), input.mShape.end(), [](int64_t dim) { return dim < 0; });
+			}
+		}
+		return input;
+	}
+
+	const TrainingColumn* TrainingBatch::FindInput(const std::string& name) const
+	{
+		auto found = std::find_if(mInputs.begin(), mInputs.end(), [&](const TrainingColumn& column) { return column.mName == name; });
+		return found != mInputs.end() ? &*found : nullptr;
+	}
+
+	const TrainingColumn* TrainingBatch::FindLabel(const std::string& name) const
+	{
+		auto found = std::find_if(mLabels.begin(), mLabels.end(), [&](const TrainingColumn& column) { return column.mName == name; });
+		return found != mLabels.end() ? &*found : nullptr;
+	}
+
+	bool TrainingBatch::Append(TrainingBatch&& other)
+	{
+		const size_t input_columns = mInputs.size();
+		const size_t label_columns = mLabels.size();
+
+		std::vector<uint64_t> input_counts;
+		std::vector<uint64_t> label_counts;
+		for (const TrainingColumn& input : mInputs)
+			input_counts.push_back(input.mCount);
+		for (const TrainingColumn& label : mLabels)
+			label_counts.push_back(label.mCount);
+
+		if (AppendColumns(mInputs, std::move(other.mInputs)) && AppendColumns(mLabels, std::move(other.mLabels)))
+			return true;
+
+		// Keep the inputs and labels aligned by dropping the whole batch
+		mInputs.erase(mInputs.begin() + input_columns, mInputs.end());
+		mLabels.erase(mLabels.begin() + label_columns, mLabels.end());
+		for (size_t i = 0; i < input_columns; ++i)
+			mInputs[i].Truncate(input_counts[i]);
+		for (size_t i = 0; i < label_columns; ++i)
+			mLabels[i].Truncate(label_counts[i]);
+
+		std::cerr << "Training batches do not match in type or shape and cannot be merged." << std::endl;
+		return false;
+	}
+
+	bool TrainingBatch::AppendColumns(std::vector<TrainingColumn>& columns,
+									  std::vector<TrainingColumn>&& others)
+	{
+		for (TrainingColumn& other : others)
+		{
+			bool created = false;
+			TrainingColumn& column = GetColumn(columns, other.mName, created);
+			if (created)
+				column = std::move(other);
+			else if (!column.Append(other))
+				return false;
+		}
+		return true;
+	}
+
+	TrainingColumn& TrainingBatch::GetColumn(std::vector<TrainingColumn>& columns,
+											 const std::string& name,
+											 bool& created)
+	{
+		auto found = std::find_if(columns.begin(), columns.end(), [&](const TrainingColumn& column) { return column.mName == name; });
+		created = found == columns.end();
+		if (!created)
+			return *found;
+
+		TrainingColumn& column = columns.emplace_back();
+		column.mName = name;
+		return column;
+	}
+
 	void TrainingBatch::ReadFromFile(const std::filesystem::path& filepath)
 	{
 		std::ifstream ifs(filepath);
@@ -31,14 +394,211 @@ namespace TF
 		ofs << to_json().dump(4);
 	}
 
+	void TrainingBatch::WriteBinaryFile(const std::filesystem::path& filepath) const
+	{
+		WriteBinaryRange(filepath, 0, UINT64_MAX);
+	}
+
+	void TrainingBatch::WriteBinaryShards(const std::filesystem::path& directory,
+										  uint64_t shard_size) const
+	{
+		const uint64_t sample_count = GetSampleCount();
+
+		// Image paths are stored as a uint64 offset followed by the characters
+		uint64_t total_size = 0;
+		for (const auto& columns : { &mInputs, &mLabels })
+		{
+			for (const TrainingColumn& column : *columns)
+			{
+				if (column.IsImage())
+				{
+					for (uint64_t i = 0; i < sample_count; ++i)
+						total_size += sizeof(uint64_t) + column.mPaths[static_cast<size_t>(i)].size();
+				}
+				else
+				{
+					total_size += sample_count * column.GetSampleSize() * column.GetElementSize();
+				}
+			}
+		}
+
+		const uint64_t sample_size = sample_count > 0 ? std::max<uint64_t>((total_size + sample_count - 1) / sample_count, 1) : 1;
+		const uint64_t shard_samples = std::max<uint64_t>(shard_size / sample_size, 1);
+
+		std::error_code ec;
+		std::filesystem::remove_all(directory, ec);
+		std::filesystem::create_directories(directory);
+
+		nlohmann::json index;
+		index["version"] = BinaryVersion;
+		index["count"] = sample_count;
+		index["shards"] = nlohmann::json::array();
+
+		for (uint64_t begin = 0, shard = 0; begin < sample_count; begin += shard_samples, ++shard)
+		{
+			std::ostringstream name;
+			name << "shard_" << std::setfill('0') << std::setw(5) << shard << ".bin";
+
+			const uint64_t end = std::min(begin + shard_samples, sample_count);
+			WriteBinaryRange(directory / name.str(), begin, end);
+
+			index["shards"].push_back(
+			{
+				{ "path", name.str() },
+				{ "count", end - begin }
+			});
+		}
+
+		// Written last, so an interrupted write leaves no index to read from
+		std::ofstream ofs(directory / "index.json");
+		if (!ofs)
+			throw std::runtime_error("Failed to open file for writing: " + (directory / "index.json").string());
+
+		ofs << index.dump(4);
+	}
+
+	uint64_t TrainingBatch::GetSampleCount() const
+	{
+		if (IsEmpty())
+			return 0;
+
+		uint64_t count = UINT64_MAX;
+		for (const auto& columns : { &mInputs, &mLabels })
+		{
+			for (const TrainingColumn& column : *columns)
+				count = std::min(count, column.mCount);
+		}
+		return count;
+	}
+
+	void TrainingBatch::WriteBinaryRange(const std::filesystem::path& filepath,
+										 uint64_t begin,
+										 uint64_t end) const
+	{
+		const auto align = [](uint64_t offset) { return (offset + BinaryAlignment - 1) / BinaryAlignment * BinaryAlignment; };
+
+		// Samples of each column within the range
+		const auto get_range = [&](const TrainingColumn& column) { return std::pair{ std::min(begin, column.mCount), std::min(end, column.mCount) }; };
+
+		// Image paths are encoded as offsets followed by the characters
+		std::unordered_map<std::string, std::vector<uint8_t>> encoded_paths;
+		for (const TrainingColumn& column : mInputs)
+		{
+			if (!column.IsImage())
+				continue;
+
+			const auto [first, last] = get_range(column);
+			const auto paths_begin = column.mPaths.begin() + static_cast<ptrdiff_t>(first);
+			const auto paths_end = column.mPaths.begin() + static_cast<ptrdiff_t>(last);
+
+			std::vector<uint64_t> offsets = { 0 };
+			for (auto path = paths_begin; path != paths_end; ++path)
+				offsets.push_back(offsets.back() + path->size());
+
+			std::vector<uint8_t>& encoded = encoded_paths[column.mName];
+			encoded.resize(offsets.size() * sizeof(uint64_t) + offsets.back());
+			std::memcpy(encoded.data(), offsets.data(), offsets.size() * sizeof(uint64_t));
+
+			uint8_t* characters = encoded.data() + offsets.size() * sizeof(uint64_t);
+			for (auto path = paths_begin; path != paths_end; ++path)
+			{
+				std::memcpy(characters, path->data(), path->size());
+				characters += path->size();
+			}
+		}
+
+		const auto get_data = [&](const TrainingColumn& column) -> std::span<const uint8_t>
+		{
+			if (column.IsImage())
+				return encoded_paths.at(column.mName);
+
+			const auto [first, last] = get_range(column);
+			const size_t sample_bytes = column.GetSampleSize() * column.GetElementSize();
+			return { static_cast<const uint8_t*>(column.GetData()) + first * sample_bytes, (last - first) * sample_bytes };
+		};
+
+		const std::pair<const char*, const std::vector<TrainingColumn>*> sections[] = { { "inputs", &mInputs }, { "labels", &mLabels } };
+
+		uint64_t data_size = 0;
+		for (const auto& [key, columns] : sections)
+		{
+			for (const TrainingColumn& column : *columns)
+				data_size += align(get_data(column).size());
+		}
+
+		const auto create_header = [&](uint64_t data_offset)
+		{
+			nlohmann::json header;
+			uint64_t offset = data_offset;
+			for (const auto& [key, columns] : sections)
+			{
+				header[key] = nlohmann::json::array();
+				for (const TrainingColumn& column : *columns)
+				{
+					header[key].push_back(
+					{
+						{ "name", column.mName },
+						{ "dtype", column.IsImage() ? "string" : GetBinaryDType(column.mType) },
+						{ "shape", column.IsImage() ? std::vector<int64_t>() : column.mShape },
+						{ "count", get_range(column).second - get_range(column).first },
+						{ "offset", offset },
+						{ "nbytes", get_data(column).size() }
+					});
+					offset += align(get_data(column).size());
+				}
+			}
+			return header.dump();
+		};
+
+		// The header size depends on the offsets it lists, so size it for the largest offsets
+		constexpr uint64_t PreambleSize = 4 + sizeof(uint32_t) + sizeof(uint64_t);
+		const uint64_t data_offset = align(PreambleSize + create_header(UINT64_MAX - data_size).size());
+
+		std::string header = create_header(data_offset);
+		header.resize(data_offset - PreambleSize, ' ');
+
+		std::filesystem::path parent_path = filepath.parent_path();
+		if (!parent_path.empty() && !std::filesystem::exists(parent_path))
+			std::filesystem::create_directories(parent_path);
+
+		std::ofstream ofs(filepath, std::ios::binary);
+		if (!ofs)
+			throw std::runtime_error("Failed to open file for writing: " + filepath.string());
+
+		const uint64_t header_size = header.size();
+		ofs.write("TFTB", 4);
+		ofs.write(reinterpret_cast<const char*>(&BinaryVersion), sizeof(BinaryVersion));
+		ofs.write(reinterpret_cast<const char*>(&header_size), sizeof(header_size));
+		ofs.write(header.data(), header.size());
+
+		const std::vector<char> padding(BinaryAlignment, 0);
+		for (const auto& [key, columns] : sections)
+		{
+			for (const TrainingColumn& column : *columns)
+			{
+				const std::span<const uint8_t> data = get_data(column);
+				ofs.write(reinterpret_cast<const char*>(data.data()), data.size());
+				ofs.write(padding.data(), align(data.size()) - data.size());
+			}
+		}
+
+		if (!ofs)
+			throw std::runtime_error("Failed to write file: " + filepath.string());
+	}
+
 	nlohmann::json TrainingBatch::to_json() const
 	{
 		nlohmann::json result;
-		for (const auto& input : mInputs)
-			result["inputs"][input.mName].push_back(input.mData);
-
-		for (const auto& label : mLabels)
-			result["labels"][label.mName].push_back(label.mData);
+		for (const auto& [key, columns] : { std::pair{ "inputs", &mInputs }, std::pair{ "labels", &mLabels } })
+		{
+			for (const TrainingColumn& column : *columns)
+			{
+				nlohmann::json& samples = result[key][column.mName];
+				samples = nlohmann::json::array();
+				for (uint64_t i = 0; i < column.mCount; ++i)
+					samples.push_back(column.GetSampleJson(i));
+			}
+		}
 
 		return result;
 	}
@@ -47,23 +607,27 @@ namespace TF
 	{
 		TrainingBatch batch;
 
-		for (auto& [key, val] : inputJson["inputs"].items())
+		for (const auto& [key, columns] : { std::pair{ "inputs", &batch.mInputs }, std::pair{ "labels", &batch.mLabels } })
 		{
-			batch.mInputs.push_back(
-			{ 
-				key, 
-				val.get<std::vector<nlohmann::json>>() 
-			});
-		}
+			if (!inputJson.contains(key))
+				continue;
 
-		for (auto& [key, val] : inputJson["labels"].items())
-		{
-			batch.mLabels.push_back(
-			{ 
-				key, 
-				val.get<std::vector<nlohmann::json>>() 
-			});
+			for (auto& [name, samples] : inputJson[key].items())
+			{
+				TrainingColumn& column = columns->emplace_back();
+				column.mName = name;
+
+				// Samples holding file paths are image inputs
+				if (!samples.empty() && samples[0].is_array() && !samples[0].empty() && samples[0][0].is_string())
+					column.mDomain = DomainType::Image;
+
+				for (const nlohmann::json& sample : samples)
+				{
+					if (!column.Append(sample))
+						throw std::runtime_error("Training data of '" + name + "' does not have the same shape for every sample.");
+				}
+			}
 		}
 		return batch;
 	}
-}
\ No newline at end of file
+}
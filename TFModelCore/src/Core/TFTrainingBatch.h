@@ -1,7 +1,14 @@
 #pragma once
 
+#include "Core/TFModelLayout.h"
+
+#include <cstdint>
+#include <iostream>
+#include <span>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <variant>
 #include <vector>
 #include <filesystem>
 
@@ -10,37 +17,209 @@
 namespace TF
 {
 	/// <summary>
-	/// Struct representing a training input.
+	/// Struct representing the samples of a training input or label, stored as one typed
+	/// contiguous buffer rather than a JSON node per value.
 	/// </summary>
-	struct NamedInput
+	struct TrainingColumn
 	{
-		// Must match ModelLayout.input.name
-		std::string mName;
+	public:
+		// Buffer of each data type, booleans being stored as uint8_t like TF_BOOL
+		using Storage = std::variant<std::vector<float>,
+									 std::vector<double>,
+									 std::vector<int32_t>,
+									 std::vector<int64_t>,
+									 std::vector<uint8_t>>;
+	public:
+		/// <summary>
+		/// Appends one sample, nested arrays being flattened. The first sample sets the shape
+		/// when it is not fully known.
+		/// </summary>
+		/// <param name="values">The sample values, or the file path of an image input</param>
+		/// <returns>True if the values match the type and shape of the column</returns>
+		bool Append(const nlohmann::json& values);
 
-		// Outer vector = batch, inner = flat feature array
-		std::vector<nlohmann::json> mData;
-	};
+		/// <summary>
+		/// Appends samples stored one after another, converted if T is not the column type.
+		/// </summary>
+		/// <param name="values">The values of every sample</param>
+		/// <param name="sample_count">The number of samples</param>
+		/// <param name="sample_shape">The shape of each sample, used if the column shape is not fully known</param>
+		/// <returns>True if the values hold sample_count samples of the column shape</returns>
+		template<typename T>
+		bool Append(std::span<const T> values,
+					uint64_t sample_count,
+					const std::vector<int64_t>& sample_shape);
 
-	/// <summary>
-	/// Struct representing a training label.
-	/// </summary>
-	struct NamedLabel
-	{
-		// Must match ModelLayout.output.name
+		/// <summary>
+		/// Appends samples stored one after another. The buffer is adopted without copying
+		/// when the column is empty and T is the column storage type.
+		/// </summary>
+		/// <param name="values">The values of every sample</param>
+		/// <param name="sample_count">The number of samples</param>
+		/// <param name="sample_shape">The shape of each sample, used if the column shape is not fully known</param>
+		/// <returns>True if the values hold sample_count samples of the column shape</returns>
+		template<typename T>
+		bool Append(std::vector<T>&& values,
+					uint64_t sample_count,
+					const std::vector<int64_t>& sample_shape);
+
+		/// <summary>
+		/// Appends the samples of another column of the same type and domain.
+		/// </summary>
+		/// <param name="other">The column to append</param>
+		/// <returns>True if the samples of the other column match the shape of the column</returns>
+		bool Append(const TrainingColumn& other);
+
+		/// <summary>
+		/// Removes the samples after the given count.
+		/// </summary>
+		/// <param name="count">The number of samples to keep</param>
+		void Truncate(uint64_t count);
+
+		/// <summary>
+		/// Retrieves the values of one sample as JSON.
+		/// </summary>
+		/// <param name="index">The sample index</param>
+		/// <returns>The flat sample values, or the file path of an image input</returns>
+		nlohmann::json GetSampleJson(uint64_t index) const;
+
+		/// <summary>
+		/// Retrieves the number of elements of each sample.
+		/// </summary>
+		/// <returns>The sample size</returns>
+		size_t GetSampleSize() const;
+
+		/// <summary>
+		/// Retrieves the size in bytes of each element.
+		/// </summary>
+		/// <returns>The element size</returns>
+		size_t GetElementSize() const;
+
+		/// <summary>
+		/// Retrieves the values of every sample.
+		/// </summary>
+		/// <returns>The contiguous values, of GetByteSize() bytes</returns>
+		const void* GetData() const;
+
+		size_t GetByteSize() const;
+
+		bool IsImage() const { return mDomain == DomainType::Image; }
+	private:
+		/// <summary>
+		/// Retrieves the buffer, switching it to the storage type of mType while empty.
+		/// </summary>
+		/// <returns>The buffer</returns>
+		Storage& GetStorage();
+
+		/// <summary>
+		/// Checks whether a number of values holds whole samples of the column shape.
+		/// </summary>
+		/// <param name="element_count">The number of values</param>
+		/// <param name="sample_count">The number of samples</param>
+		/// <param name="sample_shape">The shape of each sample, used if the column shape is not fully known</param>
+		/// <returns>True if the values can be appended</returns>
+		bool CheckSamples(size_t element_count,
+						  uint64_t sample_count,
+						  const std::vector<int64_t>& sample_shape) const;
+
+		/// <summary>
+		/// Records appended samples, setting the shape if it was not fully known.
+		/// </summary>
+		/// <param name="sample_count">The number of samples</param>
+		/// <param name="sample_shape">The shape of each sample</param>
+		void CommitSamples(uint64_t sample_count,
+						   const std::vector<int64_t>& sample_shape);
+	public:
 		std::string mName;
 
-		// e.g., one-hot vectors
-		std::vector<nlohmann::json> mData;
+		DataType mType = DataType::Float32;
+		DomainType mDomain = DomainType::Data;
+
+		// Shape of each sample, without the batch dimension
+		std::vector<int64_t> mShape;
+
+		// Whether mShape is fully known, otherwise it is set by the first sample
+		bool mShapeKnown = false;
+
+		uint64_t mCount = 0;
+
+		// mCount * GetSampleSize() elements of mType, sample after sample
+		Storage mData;
+
+		// File paths of image inputs, loaded by the training script
+		std::vector<std::string> mPaths;
 	};
 
 	/// <summary>
-	/// Struct representing a training batch.
+	/// Struct representing a training batch, holding one column per input and label name.
 	/// </summary>
 	struct TrainingBatch
 	{
 	public:
+		static constexpr uint32_t BinaryVersion = 1;
+		static constexpr uint64_t BinaryAlignment = 64;
+	public:
+		/// <summary>
+		/// Appends one sample of an input and its label. Input columns take the type and shape
+		/// of the layout input of the same name, or float32 and the shape of the first sample
+		/// otherwise. Labels are float32 like in the training script.
+		/// </summary>
+		/// <param name="input_name">The input name</param>
+		/// <param name="input_values">The input values</param>
+		/// <param name="label_name">The label name</param>
+		/// <param name="label_values">The label values</param>
+		/// <param name="layout">The model layout</param>
+		/// <returns>True if the sample was added, nothing is added otherwise</returns>
+		bool AddSample(const std::string& input_name,
+					   const nlohmann::json& input_values,
+					   const std::string& label_name,
+					   const nlohmann::json& label_values,
+					   const ModelLayout& layout);
+
 		/// <summary>
-		/// Read the training batch from a JSON file.
+		/// Appends samples of an input and their labels through the given append functions,
+		/// with columns created like in AddSample. Nothing is added unless both succeed and
+		/// add the same number of samples.
+		/// </summary>
+		/// <param name="input_name">The input name</param>
+		/// <param name="label_name">The label name</param>
+		/// <param name="layout">The model layout</param>
+		/// <param name="append_input">Function appending the input samples to a column</param>
+		/// <param name="append_label">Function appending the label samples to a column</param>
+		/// <returns>True if the samples were added</returns>
+		template<typename InputAppend, typename LabelAppend>
+		bool AddSamples(const std::string& input_name,
+						const std::string& label_name,
+						const ModelLayout& layout,
+						InputAppend&& append_input,
+						LabelAppend&& append_label);
+
+		/// <summary>
+		/// Finds the column of an input by name.
+		/// </summary>
+		/// <param name="name">The input name</param>
+		/// <returns>The column, or nullptr if the input has no samples</returns>
+		const TrainingColumn* FindInput(const std::string& name) const;
+
+		/// <summary>
+		/// Finds the column of a label by name.
+		/// </summary>
+		/// <param name="name">The label name</param>
+		/// <returns>The column, or nullptr if the label has no samples</returns>
+		const TrainingColumn* FindLabel(const std::string& name) const;
+
+		bool IsEmpty() const { return mInputs.empty() || mLabels.empty(); }
+
+		/// <summary>
+		/// Appends the samples of another batch, column by column. Columns missing from the
+		/// batch are moved over rather than copied.
+		/// </summary>
+		/// <param name="other">The batch to append</param>
+		/// <returns>True if the batch was appended, nothing is appended otherwise</returns>
+		bool Append(TrainingBatch&& other);
+
+		/// <summary>
+		/// Read the training batch from a JSON file. Values are read as float32.
 		/// </summary>
 		/// <param name="filepath">The file path</param>
 		void ReadFromFile(const std::filesystem::path& filepath);
@@ -50,7 +229,49 @@ namespace TF
 		/// </summary>
 		/// <param name="filepath">The file path</param>
 		void WriteToFile(const std::filesystem::path& filepath) const;
+
+		/// <summary>
+		/// Write the training batch to a binary columnar file, read by train_model_from_json.py
+		/// without parsing. Each input and label is stored as one contiguous typed column:
+		///
+		///   "TFTB" | uint32 format version | uint64 header size | JSON header | aligned columns
+		///
+		/// The header lists the "inputs" and "labels" columns with their name, dtype, sample shape,
+		/// sample count, and the byte offset and size of their data. Numeric data is little-endian
+		/// and aligned to BinaryAlignment bytes. Image inputs are "string" columns, stored as
+		/// count + 1 uint64 offsets followed by the UTF-8 paths.
+		/// </summary>
+		/// <param name="filepath">The file path</param>
+		void WriteBinaryFile(const std::filesystem::path& filepath) const;
+
+		/// <summary>
+		/// Write the training batch to a directory of binary files of about shard_size bytes each,
+		/// so the training script can stream them instead of loading the whole batch. Each shard is
+		/// a binary columnar file of consecutive samples, as written by WriteBinaryFile, and
+		/// "index.json" lists the shard files in sample order with their sample count.
+		/// Files of a previous write to the directory are removed.
+		/// </summary>
+		/// <param name="directory">The directory path</param>
+		/// <param name="shard_size">The approximate size in bytes of each shard</param>
+		void WriteBinaryShards(const std::filesystem::path& directory,
+							   uint64_t shard_size) const;
+
+		/// <summary>
+		/// Retrieves the number of samples held by every input and label column.
+		/// </summary>
+		/// <returns>The sample count</returns>
+		uint64_t GetSampleCount() const;
 	private:
+		/// <summary>
+		/// Write a range of samples to a binary columnar file, clamped to the samples of each column.
+		/// </summary>
+		/// <param name="filepath">The file path</param>
+		/// <param name="begin">The index of the first sample</param>
+		/// <param name="end">The index past the last sample</param>
+		void WriteBinaryRange(const std::filesystem::path& filepath,
+							  uint64_t begin,
+							  uint64_t end) const;
+
 		/// <summary>
 		/// Convert the training batch to a JSON object.
 		/// </summary>
@@ -63,8 +284,125 @@ namespace TF
 		/// <param name="inputJson">The JSON object</param>
 		/// <returns>The created training batch</returns>
 		static TrainingBatch from_json(const nlohmann::json& inputJson);
+
+		/// <summary>
+		/// Finds a column by name, creating it if needed.
+		/// </summary>
+		/// <param name="columns">The input or label columns</param>
+		/// <param name="name">The column name</param>
+		/// <param name="created">Whether the column was created</param>
+		/// <returns>The column</returns>
+		static TrainingColumn& GetColumn(std::vector<TrainingColumn>& columns,
+										 const std::string& name,
+										 bool& created);
+
+		/// <summary>
+		/// Appends columns to the columns of the same name, moving the missing ones over.
+		/// </summary>
+		/// <param name="columns">The input or label columns</param>
+		/// <param name="others">The columns to append</param>
+		/// <returns>True if every column was appended</returns>
+		static bool AppendColumns(std::vector<TrainingColumn>& columns,
+								  std::vector<TrainingColumn>&& others);
+
+		/// <summary>
+		/// Finds an input column by name, creating it with the type and shape of the layout input.
+		/// </summary>
+		/// <param name="name">The input name</param>
+		/// <param name="layout">The model layout</param>
+		/// <param name="created">Whether the column was created</param>
+		/// <returns>The column</returns>
+		TrainingColumn& GetInputColumn(const std::string& name,
+									   const ModelLayout& layout,
+									   bool& created);
 	public:
-		std::vector<NamedInput> mInputs;
-		std::vector<NamedLabel> mLabels;
+		std::vector<TrainingColumn> mInputs;
+		std::vector<TrainingColumn> mLabels;
 	};
-}
\ No newline at end of file
+
+	template<typename T>
+	bool TrainingColumn::Append(std::span<const T> values,
+								uint64_t sample_count,
+								const std::vector<int64_t>& sample_shape)
+	{
+		if (IsImage() || !CheckSamples(values.size(), sample_count, sample_shape))
+			return false;
+
+		std::visit([&](auto& data)
+		{
+			using Element = typename std::decay_t<decltype(data)>::value_type;
+			if constexpr (std::is_same_v<Element, T>)
+			{
+				data.insert(data.end(), values.begin(), values.end());
+			}
+			else
+			{
+				data.reserve(data.size() + values.size());
+				for (const T& value : values)
+					data.push_back(static_cast<Element>(value));
+			}
+		}, GetStorage());
+
+		CommitSamples(sample_count, sample_shape);
+		return true;
+	}
+
+	template<typename T>
+	bool TrainingColumn::Append(std::vector<T>&& values,
+								uint64_t sample_count,
+								const std::vector<int64_t>& sample_shape)
+	{
+		static_assert(!std::is_same_v<T, bool>, "std::vector<bool> is not contiguous, use std::vector<uint8_t>.");
+
+		std::vector<T>* data = std::get_if<std::vector<T>>(&GetStorage());
+		if (!data || !data->empty() || IsImage())
+			return Append(std::span<const T>(values), sample_count, sample_shape);
+
+		if (!CheckSamples(values.size(), sample_count, sample_shape))
+			return false;
+
+		*data = std::move(values);
+		CommitSamples(sample_count, sample_shape);
+		return true;
+	}
+
+	template<typename InputAppend, typename LabelAppend>
+	bool TrainingBatch::AddSamples(const std::string& input_name,
+								   const std::string& label_name,
+								   const ModelLayout& layout,
+								   InputAppend&& append_input,
+								   LabelAppend&& append_label)
+	{
+		bool input_created = false;
+		TrainingColumn& input = GetInputColumn(input_name, layout, input_created);
+
+		const uint64_t input_count = input.mCount;
+		if (!append_input(input))
+		{
+			if (input_created)
+				mInputs.pop_back();
+
+			std::cerr << "Training data of '" << input_name << "' does not match its type or shape." << std::endl;
+			return false;
+		}
+
+		bool label_created = false;
+		TrainingColumn& label = GetColumn(mLabels, label_name, label_created);
+
+		const uint64_t label_count = label.mCount;
+		if (!append_label(label) || label.mCount - label_count != input.mCount - input_count)
+		{
+			label.Truncate(label_count);
+			if (label_created)
+				mLabels.pop_back();
+
+			input.Truncate(input_count);
+			if (input_created)
+				mInputs.pop_back();
+
+			std::cerr << "Training label of '" << label_name << "' does not match its shape or sample count." << std::endl;
+			return false;
+		}
+		return true;
+	}
+}
@@ -12,7 +12,7 @@ namespace TF
 
 		nlohmann::json j;
 		ifs >> j;
-		TrainingConfig batch = from_json(j);
+		*this = from_json(j);
 	}
 
 	void TrainingConfig::WriteToFile(const std::filesystem::path& filepath) const
@@ -37,6 +37,14 @@ namespace TF
 		result["learning_rate"] = learning_rate;
 		result["shuffle"] = shuffle;
 		result["validation_split"] = validation_split;
+		result["optimizer"] = optimizer;
+		result["loss_function"] = loss_function;
+		result["save_model"] = save_model;
+		result["early_stopping"] = early_stopping;
+		result["early_stopping_patience"] = early_stopping_patience;
+		result["checkpoint_interval"] = checkpoint_interval;
+		result["resume"] = resume;
+		result["shard_size"] = shard_size;
 		// Add other fields as needed
 
 		return result;
@@ -56,6 +64,22 @@ namespace TF
 			config.shuffle = inputJson["shuffle"].get<bool>();
 		if (inputJson.contains("validation_split"))
 			config.validation_split = inputJson["validation_split"].get<float>();
+		if (inputJson.contains("optimizer"))
+			config.optimizer = inputJson["optimizer"].get<std::string>();
+		if (inputJson.contains("loss_function"))
+			config.loss_function = inputJson["loss_function"].get<std::string>();
+		if (inputJson.contains("save_model"))
+			config.save_model = inputJson["save_model"].get<bool>();
+		if (inputJson.contains("early_stopping"))
+			config.early_stopping = inputJson["early_stopping"].get<bool>();
+		if (inputJson.contains("early_stopping_patience"))
+			config.early_stopping_patience = inputJson["early_stopping_patience"].get<uint32_t>();
+		if (inputJson.contains("checkpoint_interval"))
+			config.checkpoint_interval = inputJson["checkpoint_interval"].get<uint32_t>();
+		if (inputJson.contains("resume"))
+			config.resume = inputJson["resume"].get<bool>();
+		if (inputJson.contains("shard_size"))
+			config.shard_size = inputJson["shard_size"].get<uint64_t>();
 		// Add other fields as needed
 
 		return config;
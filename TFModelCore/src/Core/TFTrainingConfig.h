@@ -2,11 +2,33 @@
 
 #include <string>
 #include <filesystem>
+#include <functional>
 
 #include <nlohmann/json.hpp>
 
 namespace TF
 {
+	/// <summary>
+	/// Struct representing the progress of a training, reported after each epoch.
+	/// </summary>
+	struct TrainingProgress
+	{
+	public:
+		// Completed epoch, starting at 1
+		uint32_t mEpoch = 0;
+		uint32_t mEpochs = 0;
+
+		// Mean loss over the samples of the epoch
+		float mLoss = 0.0f;
+
+		// Mean loss over the validation samples, 0 without a validation split
+		float mValidationLoss = 0.0f;
+
+		double mSamplesPerSecond = 0.0;
+	};
+
+	using TrainingCallback = std::function<void(const TrainingProgress&)>;
+
 	/// <summary>
 	/// Struct representing the configuration for training a machine learning model.
 	/// </summary>
@@ -52,16 +74,33 @@ namespace TF
 
 		// Fraction of data to reserve for validation
 		float validation_split = 0.0f;
-		
 
+		// Optimizer to use ("adam", "sgd")
+		std::string optimizer = "adam";
+
+		// Loss function to use ("categorical_crossentropy", "binary_crossentropy", "mse", "mae")
+		std::string loss_function = "categorical_crossentropy";
+
+		// Whether the trained model is saved as a new version folder. Natively trained models
+		// are published from memory, so they may skip the save.
+		bool save_model = true;
+
+		// Stop once the validation loss (or the training loss without a validation split) has not
+		// improved for early_stopping_patience epochs, keeping the weights of the best epoch
+		bool early_stopping = false;
+		uint32_t early_stopping_patience = 5;
+
+		// Number of epochs between the checkpoints written to <model root>/train/checkpoint, 0 to disable them
+		uint32_t checkpoint_interval = 0;
+
+		// Whether an interrupted training of the same version continues from its last checkpoint
+		bool resume = true;
+
+		// Approximate size in bytes of the training data shards streamed by the Python trainer
+		uint64_t shard_size = 64ull << 20;
 
 		// TODO:: Implement these options
-		//std::string optimizer = "adam";     // Optimizer to use (e.g., "adam", "sgd")
-		//std::string loss_function = "mse";  // Loss function to use (e.g., "mse", "categorical_crossentropy")
 		//std::vector<std::string> metrics;   // List of metrics to evaluate during training
-		//std::string model_save_path;        // Path to save the trained model
 		//std::string log_dir;                // Directory for logging training progress
-		//bool early_stopping = false;        // Enable early stopping based on validation loss
-		//float early_stopping_patience = 5;  // Number of epochs with no improvement before stopping
 	};
 }
\ No newline at end of file
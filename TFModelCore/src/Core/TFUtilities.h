@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "CppFlowLib.h"
+#include "Core/TFTensorView.h"
 
 namespace TF
 {
@@ -19,7 +20,7 @@ namespace TF
 	{
 		std::stringstream stream;
 		stream << "[";
-		std::vector<T> data = tensor.get_data<T>();
+		const TensorView<T> data(tensor);
 		for (uint32_t j = 0; j < data.size(); ++j)
 		{
 			stream << data[j];
@@ -1,6 +1,8 @@
 #include "Data/TFImageLoader.h"
 
 #include "CppFlowLib.h"
+#include "Core/TFTensorPool.h"
+
 #include <opencv2/opencv.hpp>
 
 namespace TF
@@ -106,26 +108,52 @@ namespace TF
 
 
 		cv::resize(image, image, cv::Size(mWidth, mHeight));
-		if (mNormalize)
+		image.convertTo(image, CV_32FC(mChannels), mNormalize ? 1.0 / 255.0 : 1.0);
+
+		std::vector<int64_t> shape;
+		switch (mShapeOrder)
 		{
-			image.convertTo(image, CV_32FC(mChannels), 1.0 / 255.0);
+			case ShapeOrder::WidthHeightChannels:
+				shape = { 1, static_cast<int64_t>(mWidth), static_cast<int64_t>(mHeight), static_cast<int64_t>(mChannels) };
+				break;
+			case ShapeOrder::HeightWidthChannels:
+				shape = { 1, static_cast<int64_t>(mHeight), static_cast<int64_t>(mWidth), static_cast<int64_t>(mChannels) };
+				break;
+			case ShapeOrder::ChannelsHeightWidth:
+				shape = { 1, static_cast<int64_t>(mChannels), static_cast<int64_t>(mHeight), static_cast<int64_t>(mWidth) };
+				break;
+			case ShapeOrder::ChannelsWidthHeight:
+				shape = { 1, static_cast<int64_t>(mChannels), static_cast<int64_t>(mWidth), static_cast<int64_t>(mHeight) };
+				break;
+			default:
+			{
+				std::cerr << "Invalid Shape Order." << std::endl;
+				return false;
+			}
 		}
 
-		std::vector<float> input_data;
+		// Pixels are written straight into the tensor buffer, leased from the pool when available
+		const size_t element_count = static_cast<size_t>(mWidth) * mHeight * mChannels;
+		TF_Tensor* tensor = mpTensorPool ? mpTensorPool->Lease(TF_FLOAT, shape) :
+										   TF_AllocateTensor(TF_FLOAT, shape.data(), static_cast<int>(shape.size()), element_count * sizeof(float));
+
+		float* input_data = static_cast<float*>(TF_TensorData(tensor));
+		size_t index = 0;
+
 		const auto InputPixel = [&](uint32_t x, uint32_t y, uint32_t c) -> bool
 		{
 			switch (mChannelOrder)
 			{
 				case ChannelOrder::GrayScale:
-					input_data.push_back(image.at<float>(y, x));
+					input_data[index++] = image.at<float>(y, x);
 					return true;
 				case ChannelOrder::BGR:
 				case ChannelOrder::RGB:
-					input_data.push_back(image.at<cv::Vec3f>(y, x)[c]);
+					input_data[index++] = image.at<cv::Vec3f>(y, x)[c];
 					return true;
 				case ChannelOrder::BGRA:
 				case ChannelOrder::RGBA:
-					input_data.push_back(image.at<cv::Vec4f>(y, x)[c]);
+					input_data[index++] = image.at<cv::Vec4f>(y, x)[c];
 					return true;
 				default:
 					std::cerr << "Unsupported Channel Order." << std::endl;
@@ -133,77 +161,56 @@ namespace TF
 			}
 		};
 
+		bool valid = true;
 		switch (mShapeOrder)
 		{
 			case ShapeOrder::HeightWidthChannels:
 			{
-				for (uint32_t y = 0; y < mHeight; ++y)
-					for (uint32_t x = 0; x < mWidth; ++x)
-						for (uint32_t c = 0; c < mChannels; ++c)
-							if (!InputPixel(x, y, c))
-								continue;
+				for (uint32_t y = 0; y < mHeight && valid; ++y)
+					for (uint32_t x = 0; x < mWidth && valid; ++x)
+						for (uint32_t c = 0; c < mChannels && valid; ++c)
+							valid = InputPixel(x, y, c);
 				break;
 			}
 			case ShapeOrder::WidthHeightChannels:
 			{
-				for (uint32_t x = 0; x < mWidth; ++x)
-					for (uint32_t y = 0; y < mHeight; ++y)
-						for (uint32_t c = 0; c < mChannels; ++c)
-							if (!InputPixel(x, y, c))
-								continue;
+				for (uint32_t x = 0; x < mWidth && valid; ++x)
+					for (uint32_t y = 0; y < mHeight && valid; ++y)
+						for (uint32_t c = 0; c < mChannels && valid; ++c)
+							valid = InputPixel(x, y, c);
 				break;
 			}
 			case ShapeOrder::ChannelsHeightWidth:
 			{
-				for (uint32_t c = 0; c < mChannels; ++c)
-					for (uint32_t y = 0; y < mHeight; ++y)
-						for (uint32_t x = 0; x < mWidth; ++x)
-							if (!InputPixel(x, y, c))
-								continue;
+				for (uint32_t c = 0; c < mChannels && valid; ++c)
+					for (uint32_t y = 0; y < mHeight && valid; ++y)
+						for (uint32_t x = 0; x < mWidth && valid; ++x)
+							valid = InputPixel(x, y, c);
 				break;
 			}
 			case ShapeOrder::ChannelsWidthHeight:
 			{
-				for (uint32_t c = 0; c < mChannels; ++c)
-					for (uint32_t x = 0; x < mWidth; ++x)
-						for (uint32_t y = 0; y < mHeight; ++y)
-							if (!InputPixel(x, y, c))
-								continue;
+				for (uint32_t c = 0; c < mChannels && valid; ++c)
+					for (uint32_t x = 0; x < mWidth && valid; ++x)
+						for (uint32_t y = 0; y < mHeight && valid; ++y)
+							valid = InputPixel(x, y, c);
 				break;
 			}
-			default:
-				std::cerr << "Unsupported Shape Order." << std::endl;
-				return false;
 		}
 
-		
-
-		if (input_data.empty())
+		if (!valid || index != element_count)
 		{
 			std::cerr << "Failed to convert image data to tensor format." << std::endl;
+			TF_DeleteTensor(tensor);
 			return false;
 		}
 
-		switch (mShapeOrder)
-		{
-			case ShapeOrder::WidthHeightChannels:
-				output = cppflow::tensor(input_data, { 1, static_cast<int64_t>(mWidth), static_cast<int64_t>(mHeight), static_cast<int64_t>(mChannels) });
-				break;
-			case ShapeOrder::HeightWidthChannels:
-				output = cppflow::tensor(input_data, { 1, static_cast<int64_t>(mHeight), static_cast<int64_t>(mWidth), static_cast<int64_t>(mChannels) });
-				break;
-			case ShapeOrder::ChannelsHeightWidth:
-				output = cppflow::tensor(input_data, { 1, static_cast<int64_t>(mChannels), static_cast<int64_t>(mHeight), static_cast<int64_t>(mWidth) });
-				break;
-			case ShapeOrder::ChannelsWidthHeight:
-				output = cppflow::tensor(input_data, { 1, static_cast<int64_t>(mChannels), static_cast<int64_t>(mWidth), static_cast<int64_t>(mHeight) });
-				break;
-			default:
-			{
-				std::cerr << "Invalid Shape Order." << std::endl;
-				return false;
-			}
-		}
+		output = cppflow::tensor(tensor);
 		return true;
 	}
+
+	void ImageTensorLoader::SetTensorPool(std::shared_ptr<TensorPool> pool)
+	{
+		mpTensorPool = std::move(pool);
+	}
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 
 namespace cppflow
 {
@@ -10,6 +11,8 @@ namespace cppflow
 
 namespace TF
 {
+	class TensorPool;
+
 	/// <summary>
 	/// Enum representing the order of channels in an image tensor.
 	/// </summary>
@@ -64,6 +67,13 @@ namespace TF
 		/// <returns>True whether the conversion is successful</returns>
 		bool Load(const std::string& image_path, 
 				  cppflow::tensor& output);
+
+		/// <summary>
+		/// Sets the pool the output tensors are leased from. Without a pool every load
+		/// allocates a new tensor.
+		/// </summary>
+		/// <param name="pool">The tensor pool or nullptr to disable pooling</param>
+		void SetTensorPool(std::shared_ptr<TensorPool> pool);
 	private:
 		uint32_t mWidth = 0;
 		uint32_t mHeight = 0;
@@ -71,5 +81,7 @@ namespace TF
 		bool mNormalize = true;
 		ChannelOrder mChannelOrder = ChannelOrder::RGBA;
 		ShapeOrder mShapeOrder = ShapeOrder::WidthHeightChannels;
+
+		std::shared_ptr<TensorPool> mpTensorPool = nullptr;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "Models/MLBatchScheduler.h"
+
+#include "Core/TFTensorUtils.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace TF
+{
+	BatchScheduler::BatchScheduler(MLModel& model,
+								   const BatchConfig& config)
+		: mModel(model),
+		mConfig(config)
+	{
+		if (mConfig.mMaxBatchSize == 0)
+			throw std::invalid_argument("Max Batch Size must be greater than zero.");
+
+		mpExecutor = std::make_unique<TaskExecutor>(mConfig.mWorkerCount, std::max<uint32_t>(mConfig.mWorkerCount, 1));
+		mDispatchThread = std::thread(&BatchScheduler::DispatchLoop, this);
+	}
+
+	BatchScheduler::~BatchScheduler()
+	{
+		{
+			const std::scoped_lock lock(mQueueMutex);
+			mStopping = true;
+		}
+		mQueueCondition.notify_all();
+
+		if (mDispatchThread.joinable())
+			mDispatchThread.join();
+
+		// Runs the batches still queued before the workers are joined
+		mpExecutor.reset();
+	}
+
+	std::future<RunResult> BatchScheduler::Submit(MLModel::LabeledTensor input_tensors)
+	{
+		Request request;
+		request.mInputs = std::move(input_tensors);
+		request.mEnqueueTime = std::chrono::steady_clock::now();
+
+		// Requests whose inputs disagree on the batch dimension are run on their own
+		for (const auto& [name, tensor] : request.mInputs)
+		{
+			std::vector<int64_t> shape = GetTensorShape(tensor);
+			const int64_t rows = shape.empty() ? -1 : shape[0];
+			if (request.mSignature.empty())
+				request.mRows = rows;
+			else if (request.mRows != rows)
+				request.mRows = -1;
+
+			if (!shape.empty())
+				shape.erase(shape.begin());
+
+			request.mSignature[name] = { tensor.dtype(), std::move(shape) };
+		}
+
+		std::future<RunResult> result = request.mPromise.get_future();
+		{
+			const std::scoped_lock lock(mQueueMutex);
+			request.mQueueDepth = static_cast<uint32_t>(mQueue.size() + 1);
+			mQueue.push_back(std::move(request));
+		}
+		mQueueCondition.notify_one();
+		return result;
+	}
+
+	void BatchScheduler::DispatchLoop()
+	{
+		while (true)
+		{
+			std::vector<Request> batch;
+			{
+				std::unique_lock lock(mQueueMutex);
+				mQueueCondition.wait(lock, [&]() { return mStopping || !mQueue.empty(); });
+
+				// Pending requests are flushed before stopping
+				if (mQueue.empty())
+					return;
+
+				const auto QueuedRows = [&]() -> int64_t
+				{
+					int64_t rows = 0;
+					for (const Request& request : mQueue)
+					{
+						if (IsCompatible(mQueue.front(), request))
+							rows += request.mRows;
+					}
+					return rows;
+				};
+
+				// Wait for the batch to fill up, bounded by the wait time of the oldest request
+				const auto deadline = mQueue.front().mEnqueueTime + mConfig.mMaxWait;
+				mQueueCondition.wait_until(lock, deadline, [&]()
+				{
+					return mStopping || mQueue.front().mRows <= 0 || QueuedRows() >= static_cast<int64_t>(mConfig.mMaxBatchSize);
+				});
+
+				int64_t rows = 0;
+				std::deque<Request> remaining;
+				for (Request& request : mQueue)
+				{
+					const bool fits = batch.empty() ||
+									  (IsCompatible(batch.front(), request) && rows + request.mRows <= static_cast<int64_t>(mConfig.mMaxBatchSize));
+					if (fits)
+					{
+						rows += request.mRows;
+						batch.push_back(std::move(request));
+					}
+					else
+					{
+						remaining.push_back(std::move(request));
+					}
+				}
+				mQueue = std::move(remaining);
+			}
+
+			// The task is copied into a std::function, so the move-only requests are shared
+			std::shared_ptr<std::vector<Request>> formed = std::make_shared<std::vector<Request>>(std::move(batch));
+			if (!mpExecutor->Submit([this, formed]() { RunBatch(*formed); }))
+				RunBatch(*formed);
+		}
+	}
+
+	void BatchScheduler::RunBatch(std::vector<Request>& batch)
+	{
+		const auto start_time = std::chrono::steady_clock::now();
+
+		// Requests are fulfilled in order, so the ones left after a failure are at the end
+		size_t fulfilled = 0;
+		const auto Fulfill = [&](Request& request, RunResult&& result)
+		{
+			result.mQueueDepth = request.mQueueDepth;
+			result.mQueueTime = std::chrono::duration_cast<std::chrono::microseconds>(start_time - request.mEnqueueTime);
+			result.mExecutionTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time);
+			request.mPromise.set_value(std::move(result));
+			++fulfilled;
+		};
+
+		try
+		{
+			if (batch.size() == 1)
+			{
+				RunResult result;
+				result.mSuccess = mModel.Run(batch.front().mInputs, result.mOutput);
+				Fulfill(batch.front(), std::move(result));
+				return;
+			}
+
+			const auto FailBatch = [&]()
+			{
+				for (Request& request : batch)
+					Fulfill(request, RunResult());
+			};
+
+			MLModel::LabeledTensor stacked_inputs;
+			for (const auto& [name, tensor] : batch.front().mInputs)
+			{
+				std::vector<cppflow::tensor> tensors;
+				tensors.reserve(batch.size());
+				for (const Request& request : batch)
+					tensors.push_back(request.mInputs.at(name));
+
+				if (!StackTensors(tensors, stacked_inputs[name]))
+				{
+					FailBatch();
+					return;
+				}
+			}
+
+			MLModel::LabeledTensor stacked_outputs;
+			if (!mModel.Run(stacked_inputs, stacked_outputs))
+			{
+				FailBatch();
+				return;
+			}
+
+			int64_t total_rows = 0;
+			for (const Request& request : batch)
+				total_rows += request.mRows;
+
+			std::vector<RunResult> results(batch.size());
+			for (const auto& [name, tensor] : stacked_outputs)
+			{
+				// Outputs without a batch dimension are shared by every request
+				const std::vector<int64_t> shape = GetTensorShape(tensor);
+				const bool batched = !shape.empty() && shape[0] == total_rows;
+
+				int64_t row = 0;
+				for (size_t i = 0; i < batch.size(); ++i)
+				{
+					if (!batched)
+					{
+						results[i].mOutput[name] = tensor;
+					}
+					else if (!SliceTensor(tensor, row, batch[i].mRows, results[i].mOutput[name]))
+					{
+						FailBatch();
+						return;
+					}
+					row += batch[i].mRows;
+				}
+			}
+
+			for (size_t i = 0; i < batch.size(); ++i)
+			{
+				results[i].mSuccess = true;
+				Fulfill(batch[i], std::move(results[i]));
+			}
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "Batched run failed: " << e.what() << std::endl;
+			for (size_t i = fulfilled; i < batch.size(); ++i)
+				batch[i].mPromise.set_value(RunResult());
+		}
+	}
+
+	bool BatchScheduler::IsCompatible(const Request& lhs,
+									  const Request& rhs)
+	{
+		if (lhs.mRows <= 0 || rhs.mRows <= 0)
+			return false;
+
+		return lhs.mSignature == rhs.mSignature;
+	}
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Models/MLModel.h"
+
+#include "Utils/TaskExecutor.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace TF
+{
+	/// <summary>
+	/// Struct representing the configuration of a BatchScheduler.
+	/// </summary>
+	struct BatchConfig
+	{
+	public:
+		// Maximum number of rows stacked into a single run
+		uint32_t mMaxBatchSize = 32;
+
+		// Maximum time the first queued request waits for the batch to fill
+		std::chrono::microseconds mMaxWait = std::chrono::microseconds(2000);
+
+		// Number of batches run concurrently while the next ones are formed, hardware concurrency if zero
+		uint32_t mWorkerCount = 0;
+	};
+
+	/// <summary>
+	/// Class collecting concurrent requests against a model with a dynamic batch dimension,
+	/// stacking them along the first dimension and running them as a single batch.
+	/// Formed batches run on a pool of workers, so they spread over the model replicas while
+	/// the dispatch thread forms the next ones.
+	/// </summary>
+	class BatchScheduler
+	{
+	public:
+		/// <summary>
+		/// Constructor initializing a BatchScheduler and starting its dispatch thread.
+		/// </summary>
+		/// <param name="model">The model to run the batches on</param>
+		/// <param name="config">The batching configuration</param>
+		BatchScheduler(MLModel& model,
+					   const BatchConfig& config = {});
+
+		/// <summary>
+		/// Destructor flushing the pending requests, waiting for the running batches and stopping the threads.
+		/// </summary>
+		~BatchScheduler();
+
+		BatchScheduler(const BatchScheduler&) = delete;
+		BatchScheduler& operator=(const BatchScheduler&) = delete;
+	public:
+		/// <summary>
+		/// Queues a request to be run as part of the next batch.
+		/// Every input tensor of the request must share the same first (batch) dimension.
+		/// </summary>
+		/// <param name="input_tensors">The input tensors</param>
+		/// <returns>The future result of the request</returns>
+		std::future<RunResult> Submit(MLModel::LabeledTensor input_tensors);
+	private:
+		/// <summary>
+		/// Struct representing a queued request.
+		/// </summary>
+		struct Request
+		{
+		public:
+			MLModel::LabeledTensor mInputs;
+
+			// Number of rows along the batch dimension, -1 if the request cannot be batched
+			int64_t mRows = 0;
+
+			// Data type and non-batch dimensions per input name
+			std::map<std::string, std::pair<TF_DataType, std::vector<int64_t>>> mSignature;
+
+			std::chrono::steady_clock::time_point mEnqueueTime;
+			uint32_t mQueueDepth = 0;
+
+			std::promise<RunResult> mPromise;
+		};
+
+		/// <summary>
+		/// Dispatch loop collecting and running batches until stopped.
+		/// </summary>
+		void DispatchLoop();
+
+		/// <summary>
+		/// Runs the given requests as a single batch and fulfills their results, failing the
+		/// unfulfilled requests if the run throws.
+		/// </summary>
+		/// <param name="batch">The batched requests</param>
+		void RunBatch(std::vector<Request>& batch);
+
+		/// <summary>
+		/// Checks whether two requests can be stacked into the same batch.
+		/// </summary>
+		/// <param name="lhs">The first request</param>
+		/// <param name="rhs">The second request</param>
+		/// <returns>True if the requests share input names, types and non-batch dimensions</returns>
+		static bool IsCompatible(const Request& lhs,
+								 const Request& rhs);
+	private:
+		MLModel& mModel;
+		BatchConfig mConfig;
+
+		std::deque<Request> mQueue;
+		std::mutex mQueueMutex = {};
+		std::condition_variable mQueueCondition;
+		bool mStopping = false;
+
+		// Runs the formed batches, its bounded queue holding the dispatch thread back while every worker is busy
+		std::unique_ptr<TaskExecutor> mpExecutor = nullptr;
+
+		std::thread mDispatchThread;
+	};
+}
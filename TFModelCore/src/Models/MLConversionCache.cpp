@@ -0,0 +1,159 @@
+#include "Models/MLConversionCache.h"
+
+#include "Utils/HashUtils.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace TF
+{
+	// Bumped whenever the layout of the cached entries changes
+	static constexpr uint64_t ConversionCacheVersion = 1;
+
+	static bool TryCreateLock(const std::filesystem::path& path,
+							  const std::string& token)
+	{
+		// Exclusive creation fails if the file already exists, making it usable as a cross-process lock
+		FILE* file = std::fopen(path.string().c_str(), "wx");
+		if (!file)
+			return false;
+
+		std::fputs(token.c_str(), file);
+		std::fclose(file);
+		return true;
+	}
+
+	static std::string ReadLockToken(const std::filesystem::path& path)
+	{
+		std::string token;
+		std::ifstream in(path);
+		in >> token;
+		return token;
+	}
+
+	// Only the process that created a lock removes it, another one may have taken over an expired lock
+	static void ReleaseLock(const std::filesystem::path& path,
+							const std::string& token)
+	{
+		std::error_code ec;
+		if (ReadLockToken(path) == token)
+			std::filesystem::remove(path, ec);
+	}
+
+	ConversionCache::ConversionCache(const std::filesystem::path& directory)
+		: mDirectory(directory)
+	{
+		std::filesystem::create_directories(mDirectory);
+	}
+
+	bool ConversionCache::ComputeKey(const std::filesystem::path& source,
+									 const std::filesystem::path& converter,
+									 std::string& key)
+	{
+		uint64_t source_hash = 0;
+		uint64_t converter_hash = ConversionCacheVersion;
+		if (!HashUtils::HashFile(source, source_hash) || !HashUtils::HashFile(converter, converter_hash))
+			return false;
+
+		key = HashUtils::ToHex(source_hash) + HashUtils::ToHex(converter_hash);
+		return true;
+	}
+
+	bool ConversionCache::GetOrConvert(const std::string& key,
+									   const ConvertFunction& convert,
+									   std::filesystem::path& entry)
+	{
+		entry = mDirectory / key;
+		const std::filesystem::path lock_path = mDirectory / (key + ".lock");
+
+		std::random_device random;
+		const std::string token = HashUtils::ToHex((static_cast<uint64_t>(random()) << 32) | random());
+
+		while (!std::filesystem::exists(entry))
+		{
+			if (!TryCreateLock(lock_path, token))
+			{
+				// Another process is converting the same model, wait for it unless it was abandoned
+				std::error_code ec;
+				const std::string holder = ReadLockToken(lock_path);
+				const auto modified = std::filesystem::last_write_time(lock_path, ec);
+				if (!ec && std::filesystem::file_time_type::clock::now() - modified > mLockTimeout && ReadLockToken(lock_path) == holder)
+				{
+					std::cerr << "Removing Abandoned Conversion Lock: " << lock_path << std::endl;
+					std::filesystem::remove(lock_path, ec);
+				}
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(250));
+				continue;
+			}
+
+			// The entry may have been published between the check and taking the lock
+			if (std::filesystem::exists(entry))
+			{
+				ReleaseLock(lock_path, token);
+				break;
+			}
+
+			// Keep the lock fresh during long conversions, so it is never taken for an abandoned one
+			std::mutex heartbeat_mutex;
+			std::condition_variable heartbeat_condition;
+			bool converting = true;
+			std::thread heartbeat([&]()
+			{
+				const std::chrono::seconds interval = std::max(std::chrono::seconds(1), mLockTimeout / 4);
+
+				std::unique_lock lock(heartbeat_mutex);
+				while (!heartbeat_condition.wait_for(lock, interval, [&]() { return !converting; }))
+				{
+					std::error_code ec;
+					if (ReadLockToken(lock_path) == token)
+						std::filesystem::last_write_time(lock_path, std::filesystem::file_time_type::clock::now(), ec);
+				}
+			});
+
+			// Convert into a private directory, published with a single rename once complete
+			const std::filesystem::path staging = mDirectory / (key + ".tmp" + std::to_string(random()));
+
+			bool success = false;
+			try
+			{
+				success = convert(staging);
+			}
+			catch (const std::exception& e)
+			{
+				std::cerr << "Failed Conversion {" << entry << "}: " << e.what() << std::endl;
+			}
+
+			{
+				const std::scoped_lock lock(heartbeat_mutex);
+				converting = false;
+			}
+			heartbeat_condition.notify_one();
+			heartbeat.join();
+
+			std::error_code ec;
+			if (success)
+			{
+				// A process that took over an abandoned lock may have published the entry first
+				std::filesystem::rename(staging, entry, ec);
+				if (ec && !std::filesystem::exists(entry))
+				{
+					std::cerr << "Failed to Publish Conversion {" << entry << "}: " << ec.message() << std::endl;
+					success = false;
+				}
+			}
+
+			std::filesystem::remove_all(staging, ec);
+			ReleaseLock(lock_path, token);
+			return success;
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <string>
+
+namespace TF
+{
+	/// <summary>
+	/// Class representing a content-addressed directory of converted models. Entries are keyed by
+	/// a hash of the source model bytes and the converter, and are published with an atomic rename
+	/// under a lock file so concurrent processes convert a given model only once. Each lock holds
+	/// a token of the process that created it, which is the only one to remove it.
+	/// </summary>
+	class ConversionCache
+	{
+	public:
+		using ConvertFunction = std::function<bool(const std::filesystem::path& output)>;
+	public:
+		/// <summary>
+		/// Constructor initializing a ConversionCache, creating its directory if needed.
+		/// </summary>
+		/// <param name="directory">The cache directory</param>
+		ConversionCache(const std::filesystem::path& directory);
+
+		/// <summary>
+		/// Computes the cache key of a source model from its contents and the converter script.
+		/// </summary>
+		/// <param name="source">The source model file</param>
+		/// <param name="converter">The converter script, changes to which invalidate the cached entries</param>
+		/// <param name="key">The computed key</param>
+		/// <returns>True if the files could be read</returns>
+		static bool ComputeKey(const std::filesystem::path& source,
+							   const std::filesystem::path& converter,
+							   std::string& key);
+
+		/// <summary>
+		/// Retrieves the cached conversion for the key, running the conversion if there is none.
+		/// If another process holds the key's lock, this waits for its conversion instead.
+		/// </summary>
+		/// <param name="key">The cache key</param>
+		/// <param name="convert">The conversion, writing into the given directory</param>
+		/// <param name="entry">The cached conversion directory</param>
+		/// <returns>True if a conversion is available</returns>
+		bool GetOrConvert(const std::string& key,
+						  const ConvertFunction& convert,
+						  std::filesystem::path& entry);
+	public:
+		// Age after which the lock of a conversion is considered abandoned by a crashed process.
+		// Running conversions refresh their lock every quarter of it.
+		std::chrono::seconds mLockTimeout = std::chrono::seconds(1800);
+	private:
+		std::filesystem::path mDirectory;
+	};
+}
@@ -1,14 +1,99 @@
 #include "Models/MLModel.h"
 
+#include "Core/TFGraphBuilder.h"
+#include "Core/TFTensorUtils.h"
+
 #include "Utils/ConsoleUtils.h"
+#include "Utils/HashUtils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <random>
+#include <thread>
 
 
 namespace TF
 {
+	// Written next to the checkpoint once complete, naming the trained version and epoch
+	static constexpr const char* CheckpointStateFilename = "checkpoint_state.json";
+
+	size_t ModelInstance::SelectReplica() const
+	{
+		size_t selected = 0;
+		uint32_t least_load = UINT32_MAX;
+		for (size_t i = 0; i < mReplicas.size(); ++i)
+		{
+			const uint32_t load = mReplicas[i]->GetInFlightCount();
+			if (load < least_load)
+			{
+				selected = i;
+				least_load = load;
+			}
+		}
+		return selected;
+	}
+
+
+	void TrainingJob::Cancel()
+	{
+		mCancelled.store(true, std::memory_order_relaxed);
+
+		const std::scoped_lock lock(mCancelMutex);
+		if (!mFinished && !mCancelPath.empty())
+		{
+			std::ofstream cancel_file(mCancelPath);
+		}
+	}
+
+	bool TrainingJob::IsDone() const
+	{
+		return WaitFor(std::chrono::milliseconds(0));
+	}
+
+	bool TrainingJob::Wait() const
+	{
+		return mResult.get();
+	}
+
+	bool TrainingJob::WaitFor(std::chrono::milliseconds timeout) const
+	{
+		return mResult.wait_for(timeout) == std::future_status::ready;
+	}
+
+	TrainingProgress TrainingJob::GetProgress() const
+	{
+		const std::scoped_lock lock(mProgressMutex);
+		return mProgress;
+	}
+
+	void TrainingJob::ReportProgress(const TrainingProgress& progress)
+	{
+		{
+			const std::scoped_lock lock(mProgressMutex);
+			mProgress = progress;
+		}
+
+		if (mOnProgress)
+			mOnProgress(progress);
+	}
+
+	void TrainingJob::Finish(bool trained)
+	{
+		{
+			const std::scoped_lock lock(mCancelMutex);
+			mFinished = true;
+
+			std::error_code ec;
+			std::filesystem::remove(mCancelPath, ec);
+		}
+		mPromise.set_value(trained);
+	}
+
+
 	MLModel::MLModel(const std::string& modelname,
 					 const std::filesystem::path& output)
-		: mName(modelname),
-		mpModel(nullptr)
+		: mName(modelname)
 	{
 		mLayout.mModelName = modelname;
 
@@ -59,7 +144,6 @@ namespace TF
 		}
 
 
-		const std::string model_path = CreateModelName();
 		if (!std::filesystem::exists(loadpath))
 		{
 			std::cerr << "Load Model Path Does Not Exist: " << loadpath << std::endl;
@@ -67,44 +151,12 @@ namespace TF
 		}
 
 
-		std::stringstream cmd;
-		cmd << "python \"" 
-			<< mScriptDirectory 
-			<< "/extract_model_info.py\""
-			<< " \"" << output_path << "\"";
-
-		if (!ConsoleUtils::Execute(cmd.str().c_str()))
-		{
-			std::cerr << "Failed to Extract Info From SavedModel {" << output_path << "}" << std::endl;
-			return false;
-		}
-
-		// Load JSON with input/output tensor names
-		std::ifstream in(output_path + "/cppflow_io_names.json");
-		if (!in.is_open())
-		{
-			std::cerr << "Failed to open cppflow_io_names.json" << std::endl;
+		// The input/output names are read from the SavedModel's signature as it is loaded
+		std::shared_ptr<ModelInstance> instance = LoadInstance(output_path, mModelVersion);
+		if (!instance)
 			return false;
-		}
-
-		nlohmann::json io_names;
-		in >> io_names;
-
-		for (auto& [key, val] : io_names["outputs"].items())
-		{
-			const std::string ioName = val.get<std::string>();
-			mOutputIONamesMap[ioName] = key;
-			mOutputIONames.push_back(ioName);
-		}
 
-		for (auto& [key, val] : io_names["inputs"].items())
-			mInputToIONamesMap[key] = val.get<std::string>();
-
-
-		{
-			const std::scoped_lock lock(mModelMutex);
-			mpModel = std::make_unique<cppflow::model>(model_path);
-		}
+		PublishInstance(std::move(instance), PublishMode::Reset);
 		return true;
 	}
 
@@ -140,21 +192,15 @@ namespace TF
 		});
 	}
 
-	void MLModel::AddTrainingData(const std::string& input_name, 
+	bool MLModel::AddTrainingData(const std::string& input_name, 
 								  const nlohmann::json& input_values,
 								  const std::string& label_name,
 								  const nlohmann::json& label_outputs)
 	{
-		NamedInput input;
-		input.mName = input_name;
-		input.mData = input_values;
-
-		NamedLabel label;
-		label.mName = label_name;
-		label.mData = label_outputs;
-
-		mCurrentTrainingBatch.mInputs.push_back(input);
-		mCurrentTrainingBatch.mLabels.push_back(label);
+		return mTrainingStore.Add([&](TrainingBatch& batch)
+		{
+			return batch.AddSample(input_name, input_values, label_name, label_outputs, mLayout);
+		});
 	}
 
 	void MLModel::SaveLayoutJson(const std::filesystem::path& path) const
@@ -164,66 +210,99 @@ namespace TF
 
 	void MLModel::SaveTrainingJson(const std::filesystem::path& path) const
 	{
-		mCurrentTrainingBatch.WriteToFile(path);
+		mTrainingStore.Snapshot()->WriteToFile(path);
 	}
 
-	bool MLModel::CreateModel()
+	void MLModel::SaveTrainingBinary(const std::filesystem::path& path) const
 	{
-		mOutputIONames.clear();
+		mTrainingStore.Snapshot()->WriteBinaryFile(path);
+	}
 
+	bool MLModel::CreateModel(bool force_rebuild)
+	{
 		const std::string model_path_root = GetModelRoot();
+		const std::string saved_model_path = CreateModelName(0);
+		const std::string layout_hash_path = saved_model_path + "/layout_hash";
 
 		// Write the layout to a file
 		const std::string model_description_path = model_path_root + "/model_description.json";
 		mLayout.WriteToFile(model_description_path);
 
-		// Run the Python script to create the model
-		std::stringstream python_script;
-		python_script << "python \"" 
-					  << mScriptDirectory 
-					  << "/build_model_from_json.py\"" 
-					  << " \"" << model_path_root << "\""
-					  << " \"0\"";
+		// Changes to the builder invalidate previous builds as well
+		uint64_t build_hash = mLayout.ComputeHash();
+		if (mUseNativeBuilder)
+			build_hash = HashUtils::HashBytes(&GraphBuilder::Version, sizeof(GraphBuilder::Version), build_hash);
+		else
+			HashUtils::HashFile(mScriptDirectory + "/build_model_from_json.py", build_hash);
+		const std::string layout_hash = HashUtils::ToHex(build_hash);
 
-		std::string output;
-		if (!ConsoleUtils::Execute(python_script.str().c_str(), &output))
+		std::shared_ptr<ModelInstance> instance = nullptr;
+
+		std::string stored_hash;
+		if (std::ifstream in(layout_hash_path); in.is_open())
+			in >> stored_hash;
+
+		if (!force_rebuild && stored_hash == layout_hash)
 		{
-			std::cerr << "Failed Model Creation {" << mName << "}: \n\t" << output << std::endl;
-			return false;
+			std::cout << "Reusing Model Build {" << saved_model_path << "}" << std::endl;
+			instance = LoadInstance(saved_model_path, 0);
 		}
 
-		mModelVersion = 0;
+		if (!instance)
+		{
+			// Invalidate the previous build first so an interrupted build is never reused
+			std::error_code ec;
+			std::filesystem::remove(layout_hash_path, ec);
 
-		std::cout << output << std::endl;
+			if (mUseNativeBuilder)
+			{
+				GraphBuilder builder;
+				if (!builder.Build(mLayout))
+					return false;
 
-		// Load JSON with input/output tensor names
-		const std::string model_path = CreateModelName();
-		const std::string io_names_path = model_path + "/cppflow_io_names.json";
-		std::ifstream in(io_names_path);
-		if (!in.is_open())
-		{
-			std::cerr << "Failed to open cppflow_io_names.json" << std::endl;
-			return false;
-		}
+				std::filesystem::remove_all(saved_model_path, ec);
+				if (!builder.Save(saved_model_path))
+				{
+					std::cerr << "Failed Model Creation {" << mName << "}" << std::endl;
+					return false;
+				}
+			}
+			else if (!BuildModelWithPython(model_path_root))
+			{
+				return false;
+			}
 
-		nlohmann::json io_names;
-		in >> io_names;
+			// Load the new model outside of any lock, in-flight runs keep using the previous version
+			instance = LoadInstance(saved_model_path, 0);
+			if (!instance)
+				return false;
 
-		for (auto& [key, val] : io_names["outputs"].items())
-		{
-			const std::string ioName = val.get<std::string>();
-			mOutputIONamesMap[ioName] = key;
-			mOutputIONames.push_back(ioName);
+			std::ofstream(layout_hash_path) << layout_hash;
 		}
 
-		for (auto& [key, val] : io_names["inputs"].items())
-			mInputToIONamesMap[key] = val.get<std::string>();
+		PublishInstance(std::move(instance), PublishMode::Reset);
+		return true;
+	}
+
+	bool MLModel::BuildModelWithPython(const std::string& model_path_root)
+	{
+		// Run the Python script to create the model
+		std::stringstream python_script;
+		python_script << "python \"" 
+					  << mScriptDirectory 
+					  << "/build_model_from_json.py\"" 
+					  << " \"" << model_path_root << "\""
+					  << " \"0\"";
 
+		std::string output;
+		if (!RunPythonCommand("build",
+							  { { "model_path", model_path_root }, { "version", 0 } },
+							  [&](std::string& script_output) { return ConsoleUtils::Execute(python_script.str().c_str(), &script_output); },
+							  output))
 		{
-			const std::scoped_lock lock(mModelMutex);
-			mpModel = std::make_unique<cppflow::model>(model_path);
+			std::cerr << "Failed Model Creation {" << mName << "}: \n\t" << output << std::endl;
+			return false;
 		}
-
 		return true;
 	}
 
@@ -233,10 +312,6 @@ namespace TF
 							 bool shuffle, 
 							 float validation_split)
 	{
-		if (mCurrentTrainingBatch.mInputs.empty() || mCurrentTrainingBatch.mLabels.empty())
-			return false;
-
-
 		TF::TrainingConfig config;
 		config.epochs			= epochs;
 		config.batch_size		= batchSize;
@@ -244,136 +319,1178 @@ namespace TF
 		config.shuffle			= shuffle;
 		config.validation_split = validation_split;
 
-		const std::string model_path_root = GetModelRoot();
-		std::string training_config_path = model_path_root + "/train/train_config.json";
-		std::string training_data_path = model_path_root + "/train/train_data.json";
+		return TrainModel(config);
+	}
 
-		config.WriteToFile(training_config_path);
+	bool MLModel::TrainModel(const TrainingConfig& config)
+	{
+		const std::shared_ptr<const TrainingBatch> batch = mTrainingStore.Snapshot();
+		return RunTraining(config, *batch, nullptr);
+	}
 
-		mCurrentTrainingBatch.WriteToFile(model_path_root + "/train/train_data.json");
+	std::shared_ptr<TrainingJob> MLModel::TrainModelAsync(const TrainingConfig& config,
+														  TrainingCallback on_progress)
+	{
+		std::shared_ptr<TrainingJob> job = std::make_shared<TrainingJob>();
+		job->mOnProgress = std::move(on_progress);
 
-		std::stringstream trainCmd;
-		trainCmd << "python \"" 
-				 << mScriptDirectory 
-				 << "/train_model_from_json.py\""
-				 << " \"" << model_path_root << "\""
-				 << " \"" << mModelVersion.load() << "\""
-				 << " \"" << mModelVersion.load() + 1 << "\""
-				 << " \"" << training_config_path << "\""
-				 << " \"" << training_data_path << "\"";
+		// Unique per job, so a cancel never reaches another training of the model
+		std::random_device random;
+		job->mCancelPath = GetModelRoot() + "/train/cancel_" + HashUtils::ToHex((static_cast<uint64_t>(random()) << 32) | random());
 
-		std::string output;
-		if (!ConsoleUtils::Execute(trainCmd.str().c_str(), &output))
+		// Train on a snapshot of the data added so far, so ingestion can continue meanwhile
+		std::future<void> task = std::async(std::launch::async, [this, job, config, batch = mTrainingStore.Snapshot()]()
 		{
-			std::cerr << "Failed Execute Training On {" << mName << "}: \n\t" << output << std::endl;
+			bool trained = false;
+			try
+			{
+				trained = RunTraining(config, *batch, job.get());
+			}
+			catch (const std::exception& e)
+			{
+				std::cerr << "Failed Training On {" << mName << "}: " << e.what() << std::endl;
+			}
+			job->Finish(trained);
+		});
+
+		const std::scoped_lock lock(mTrainingTasksMutex);
+		std::erase_if(mTrainingTasks, [](const std::future<void>& pending)
+		{
+			return pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		});
+		mTrainingTasks.push_back(std::move(task));
+		return job;
+	}
+
+	bool MLModel::RunTraining(const TrainingConfig& config,
+							  const TrainingBatch& batch,
+							  TrainingJob* job)
+	{
+		if (batch.IsEmpty())
 			return false;
-		}
 
-		std::cout << output << std::endl;
+		const std::scoped_lock lock(mTrainingMutex);
 
-		// Update Model
+		// Jobs cancelled while waiting for a previous training never start
+		if (job && job->IsCancelled())
+			return false;
+
+		// Versions after a rollback may already exist, so always train into a fresh version
+		const uint32_t next_version = GetNextVersion();
+
+		// Natively built versions carry their training info, or are the last natively trained version
+		const std::shared_ptr<const ModelInstance> instance = mpModel.load(std::memory_order_acquire);
+		if (instance && ((mpTrainer && mTrainerVersion == instance->mVersion) ||
+						 std::filesystem::exists(CreateModelName(instance->mVersion) + "/" + GraphTrainingInfo::Filename)))
 		{
-			const std::scoped_lock lock(mModelMutex);
-			const std::string output_path = CreateModelName(++mModelVersion);
-			mpModel = std::make_unique<cppflow::model>(output_path);
+			return TrainModelNative(config, batch, instance, next_version, job);
 		}
 
-		return true;
+		return TrainModelPython(config, batch, next_version, job);
 	}
 
-	bool MLModel::Run(const LabeledTensor& input_tensors,
-					  LabeledTensor& output)
+	bool MLModel::TrainModelNative(const TrainingConfig& config,
+								   const TrainingBatch& batch,
+								   const std::shared_ptr<const ModelInstance>& instance,
+								   uint32_t next_version,
+								   TrainingJob* job)
 	{
+		std::vector<std::string> output_names;
+		for (const auto& [key, ioName] : instance->mOutputToIONamesMap)
+			output_names.push_back(ioName);
+
+		// Continue from the weights in memory when training the last trained version again
+		try
 		{
-			const std::scoped_lock lock(mModelMutex);
-			if (!mpModel)
-				return false;
-		}
+			if (!mpTrainer || mTrainerVersion != instance->mVersion)
+			{
+				const std::string source_path = CreateModelName(instance->mVersion);
+
+				GraphTrainingInfo info;
+				info.ReadFromFile(source_path + "/" + GraphTrainingInfo::Filename);
 
-		if (mOutputIONamesMap.empty())
+				mpTrainer = std::make_shared<Trainer>(std::make_shared<Session>(source_path, mSessionConfig), info, output_names, config);
+				mTrainerVersion = instance->mVersion;
+				mTrainerSourcePath = source_path;
+			}
+			else if (!mpTrainer->IsCompatible(config))
+			{
+				mpTrainer = std::make_shared<Trainer>(mpTrainer->GetSession(), mpTrainer->GetTrainingInfo(), mpTrainer->GetOutputNames(), config);
+			}
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "Failed Native Training Setup {" << mName << "}: " << e.what() << std::endl;
 			return false;
+		}
 
-		std::vector<std::tuple<std::string, cppflow::tensor>> inputs_vec;
-		for (const auto& [name, tensor] : input_tensors)
+		const Session& session = *mpTrainer->GetSession();
+		const auto create_tensor = [&](const std::string& ioName,
+									   const TrainingColumn* column,
+									   bool label,
+									   cppflow::tensor& tensor)
 		{
-			auto found = mInputToIONamesMap.find(name);
-			if (found == mInputToIONamesMap.end())
+			if (!column)
 			{
-				std::cerr << "Input name '" << name << "' not found in model input names." << std::endl;
-				continue;
+				std::cerr << "Missing training data for '" << ioName << "'." << std::endl;
+				return false;
 			}
 
-			inputs_vec.emplace_back(found->second, tensor);
+			TF_DataType dtype;
+			std::vector<int64_t> shape;
+			if (!session.GetTensorSpec(ioName, dtype, shape) || shape.empty() ||
+				std::any_of(shape.begin() + 1, shape.end(), [](int64_t dim) { return dim < 0; }))
+			{
+				std::cerr << "Native training requires known sample shapes for '" << ioName << "'." << std::endl;
+				return false;
+			}
+
+			// Labels are float32 like in the training script
+			const std::vector<int64_t> sample_shape(shape.begin() + 1, shape.end());
+			return CreateTensorFromColumn(*column, label ? TF_FLOAT : dtype, sample_shape, tensor);
+		};
+
+		std::vector<std::tuple<std::string, cppflow::tensor>> inputs;
+		for (const auto& [key, ioName] : instance->mInputToIONamesMap)
+		{
+			cppflow::tensor tensor;
+			if (!create_tensor(ioName, batch.FindInput(key), false, tensor))
+				return false;
+
+			inputs.emplace_back(ioName, std::move(tensor));
 		}
 
-		std::vector<cppflow::tensor> results;
+		std::vector<cppflow::tensor> labels;
+		for (const std::string& ioName : mpTrainer->GetOutputNames())
 		{
-			const std::scoped_lock lock(mModelMutex);
-			results = std::move((*mpModel)(inputs_vec, mOutputIONames));
+			auto found = instance->mOutputIONamesMap.find(ioName);
+			if (found == instance->mOutputIONamesMap.end())
+				return false;
+
+			cppflow::tensor tensor;
+			if (!create_tensor(ioName, batch.FindLabel(found->second), true, tensor))
+				return false;
+
+			labels.push_back(std::move(tensor));
 		}
 
-		for (size_t i = 0; i < results.size(); ++i)
+		// Continue an interrupted training of this version from its last checkpoint
+		uint32_t initial_epoch = config.resume ? GetCheckpointEpoch(instance->mVersion) : 0;
+		if (initial_epoch > 0)
 		{
-			const std::string& output_name = mOutputIONames[i];
-			auto found = mOutputIONamesMap.find(output_name);
-			if (found == mOutputIONamesMap.end())
+			try
 			{
-				std::cerr << "Output name '" << output_name << "' not found in model output names." << std::endl;
-				continue;
+				if (!mpTrainer->RestoreWeights(*std::make_shared<Session>(GetCheckpointPath(), mSessionConfig)))
+					initial_epoch = 0;
 			}
-			else
+			catch (const std::exception& e)
 			{
-				output[found->second] = results[i];
+				std::cerr << "Failed to Load Checkpoint {" << mName << "}: " << e.what() << std::endl;
+				initial_epoch = 0;
 			}
+
+			if (initial_epoch > 0)
+				std::cout << "Resuming Training From Epoch " << initial_epoch << "." << std::endl;
+		}
+
+		const TrainingCallback on_epoch = [&](const TrainingProgress& progress)
+		{
+			if (config.checkpoint_interval > 0 && progress.mEpoch % config.checkpoint_interval == 0)
+				WriteCheckpoint(instance->mVersion, progress.mEpoch);
+
+			if (job)
+				job->ReportProgress(progress);
+		};
+
+		if (!mpTrainer->Train(inputs, labels, config, on_epoch, job ? &job->mCancelled : nullptr, initial_epoch))
+		{
+			// Discard the partially trained weights, so the next training starts from the served version
+			if (instance->mReplicas.empty() || !mpTrainer->RestoreWeights(*instance->mReplicas.front()))
+				mpTrainer = nullptr;
+
+			if (!job || !job->IsCancelled())
+				std::cerr << "Failed Native Training On {" << mName << "}" << std::endl;
+			return false;
+		}
+
+		if (config.save_model && !mpTrainer->Save(mTrainerSourcePath, CreateModelName(next_version)))
+			return false;
+
+		// Serve copies of the trained weights, so the next training does not affect the published version
+		std::shared_ptr<ModelInstance> trained = std::make_shared<ModelInstance>();
+		trained->mVersion = next_version;
+		trained->mInputToIONamesMap = instance->mInputToIONamesMap;
+		trained->mOutputIONamesMap = instance->mOutputIONamesMap;
+		trained->mOutputToIONamesMap = instance->mOutputToIONamesMap;
+		trained->mOutputIONames = instance->mOutputIONames;
+
+		const SessionConfig replica_config = GetReplicaConfig();
+		for (uint32_t i = 0; i < std::max(1u, mReplicaCount); ++i)
+		{
+			std::shared_ptr<Session> replica = mpTrainer->CreateServingSession(replica_config);
+			if (!replica)
+				return false;
+
+			trained->mReplicas.push_back(std::move(replica));
 		}
+
+		if (mWarmupConfig.mEnabled)
+			WarmupInstance(*trained);
+
+		PublishInstance(std::move(trained));
+		mTrainerVersion = next_version;
+
+		std::error_code ec;
+		std::filesystem::remove_all(GetCheckpointPath(), ec);
 		return true;
 	}
 
-	void MLModel::ExportAll(const std::filesystem::path& directory) const
+	bool MLModel::TrainModelPython(const TrainingConfig& config,
+								   const TrainingBatch& batch,
+								   uint32_t next_version,
+								   TrainingJob* job)
 	{
-		std::filesystem::path dir_path(directory);
-		if (!std::filesystem::exists(dir_path))
-			std::filesystem::create_directories(dir_path);
+		const std::string model_path_root = GetModelRoot();
+		std::string training_config_path = model_path_root + "/train/train_config.json";
+		std::string training_data_path = model_path_root + "/train/train_data";
 
-		mLayout.WriteToFile(dir_path / "model_layout.json");
-		mCurrentTrainingBatch.WriteToFile(dir_path / "train_data.json");
+		config.WriteToFile(training_config_path);
 
-		std::cout << "Model and Training Data Exported to: " << dir_path << std::endl;
-	}
+		// Shards of typed columns are streamed by the training script, bounding its memory use
+		batch.WriteBinaryShards(training_data_path, config.shard_size);
 
-	bool MLModel::ConvertModelToSavedModel(const std::filesystem::path& filepath,
-										   const std::filesystem::path& outputpath)
-	{
-		std::stringstream cmd;
-		cmd << "python \"" 
-			<< mScriptDirectory 
-			<< "/convert_onnx_to_saved_model.py\""
-		    << " \"" << filepath.string() << "\""
-		    << " \"" << outputpath.string() << "\"";
+		const uint32_t current_version = mModelVersion;
+
+		std::stringstream trainCmd;
+		trainCmd << "python \"" 
+				 << mScriptDirectory 
+				 << "/train_model_from_json.py\""
+				 << " \"" << model_path_root << "\""
+				 << " \"" << current_version << "\""
+				 << " \"" << next_version << "\""
+				 << " \"" << training_config_path << "\""
+				 << " \"" << training_data_path << "\"";
+		if (job)
+			trainCmd << " \"" << job->mCancelPath.string() << "\"";
+
+		nlohmann::json train_args =
+		{
+			{ "model_path", model_path_root },
+			{ "input_version", current_version },
+			{ "output_version", next_version },
+			{ "train_config", training_config_path },
+			{ "train_data", training_data_path }
+		};
+		if (job)
+			train_args["cancel_path"] = job->mCancelPath.string();
+
+		const auto on_event = [job](const nlohmann::json& event)
+		{
+			if (!job || event.value("event", "") != "progress")
+				return;
+
+			TrainingProgress progress;
+			progress.mEpoch = event.value("epoch", 0u);
+			progress.mEpochs = event.value("epochs", 0u);
+			progress.mLoss = event.value("loss", 0.0f);
+			progress.mValidationLoss = event.value("val_loss", 0.0f);
+			progress.mSamplesPerSecond = event.value("samples_per_sec", 0.0);
+			job->ReportProgress(progress);
+		};
+
+		// The script prints each epoch's progress as a JSON line, read while it trains
+		const auto run_script = [&](std::string& script_output)
+		{
+			return ConsoleUtils::ExecuteStreaming(trainCmd.str().c_str(), [&](const std::string& line)
+			{
+				// Keras may not have ended its progress bar line yet when the event is printed
+				const size_t start = line.find("{\"event\"");
+				if (start != std::string::npos)
+				{
+					nlohmann::json event;
+					try
+					{
+						event = nlohmann::json::parse(line.substr(start));
+					}
+					catch (const std::exception&)
+					{
+						// Not an event after all, kept as regular output
+					}
+
+					if (event.is_object())
+					{
+						if (start > 0)
+							script_output += line.substr(0, start) + "\n";
+
+						on_event(event);
+						return;
+					}
+				}
+				script_output += line + "\n";
+			});
+		};
 
-		int32_t exit_code = std::system(cmd.str().c_str());
-		if (exit_code != 0)
+		std::string output;
+		if (!RunPythonCommand("train",
+							  train_args,
+							  run_script,
+							  output,
+							  on_event))
 		{
-			std::cerr << "Failed to convert model to SavedModel format. Exit code: " << exit_code << std::endl;
+			std::cerr << "Failed Execute Training On {" << mName << "}: \n\t" << output << std::endl;
 			return false;
 		}
-		return true;	
+
+		// Update Model
+		return PublishVersion(next_version);
 	}
 
-	std::string MLModel::GetModelRoot() const
+	uint32_t MLModel::GetNextVersion() const
 	{
-		return mOutputDirectory + "/" + mName;
+		// Natively trained versions may be published without being saved
+		const std::vector<uint32_t> versions = GetAvailableVersions();
+		return std::max<uint32_t>(mModelVersion, versions.empty() ? 0 : versions.back()) + 1;
 	}
 
-	std::string MLModel::CreateModelName(int32_t version) const
+	uint32_t MLModel::GetCheckpointEpoch(uint32_t version) const
 	{
-		if(version < 0)
+		std::ifstream ifs(GetCheckpointPath() + "/" + CheckpointStateFilename);
+		if (!ifs)
+			return 0;
+
+		nlohmann::json state;
+		try
 		{
-			return mOutputDirectory + "/" + mName + "/Saved_" + std::to_string(mModelVersion.load());
+			ifs >> state;
 		}
-		else
+		catch (const std::exception&)
 		{
-			return mOutputDirectory + "/" + mName + "/Saved_" + std::to_string(version);
+			return 0;
+		}
+
+		if (state.value("input_version", int64_t(-1)) != static_cast<int64_t>(version))
+			return 0;
+
+		return state.value("epoch", 0u);
+	}
+
+	bool MLModel::WriteCheckpoint(uint32_t version,
+								  uint32_t epoch) const
+	{
+		const std::filesystem::path checkpoint_path = GetCheckpointPath();
+		const std::filesystem::path state_path = checkpoint_path / CheckpointStateFilename;
+
+		// Invalidate the previous checkpoint while it is overwritten
+		std::error_code ec;
+		std::filesystem::remove(state_path, ec);
+
+		if (!mpTrainer || !mpTrainer->Save(mTrainerSourcePath, checkpoint_path))
+		{
+			std::cerr << "Failed to Write Checkpoint {" << mName << "}" << std::endl;
+			return false;
+		}
+
+		std::ofstream ofs(state_path);
+		if (!ofs)
+			return false;
+
+		ofs << nlohmann::json{ { "input_version", version }, { "epoch", epoch } }.dump(4);
+		return true;
+	}
+
+	bool MLModel::PublishVersion(uint32_t version)
+	{
+		std::shared_ptr<ModelInstance> instance = LoadVersion(version);
+		if (!instance)
+			return false;
+
+		PublishInstance(std::move(instance));
+		return true;
+	}
+
+	std::future<bool> MLModel::PublishVersionAsync(uint32_t version)
+	{
+		return std::async(std::launch::async, [this, version]()
+		{
+			return PublishVersion(version);
+		});
+	}
+
+	bool MLModel::RollbackVersion()
+	{
+		std::vector<uint32_t> history;
+		{
+			const std::scoped_lock lock(mModelMutex);
+			if (mVersionHistory.size() < 2)
+				return false;
+
+			history = mVersionHistory;
+		}
+
+		// Loaded outside of the lock, the publish fails if another publish or rollback happened meanwhile
+		std::shared_ptr<ModelInstance> instance = LoadVersion(history[history.size() - 2]);
+		if (!instance)
+			return false;
+
+		if (!PublishInstance(std::move(instance), PublishMode::Rollback, &history))
+		{
+			std::cerr << "Version History Changed During Rollback {" << mName << "}" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	std::vector<uint32_t> MLModel::GetAvailableVersions() const
+	{
+		std::vector<uint32_t> versions;
+
+		const std::filesystem::path model_root = GetModelRoot();
+		if (!std::filesystem::is_directory(model_root))
+			return versions;
+
+		const std::string prefix = "Saved_";
+		for (const auto& entry : std::filesystem::directory_iterator(model_root))
+		{
+			const std::string name = entry.path().filename().string();
+			if (!entry.is_directory() || name.rfind(prefix, 0) != 0)
+				continue;
+
+			const std::string number = name.substr(prefix.size());
+			if (!number.empty() && std::all_of(number.begin(), number.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); }))
+				versions.push_back(static_cast<uint32_t>(std::stoul(number)));
+		}
+
+		std::sort(versions.begin(), versions.end());
+		return versions;
+	}
+
+	bool MLModel::Run(const LabeledTensor& input_tensors,
+					  LabeledTensor& output)
+	{
+		return Run(input_tensors, output, {});
+	}
+
+	bool MLModel::Run(const LabeledTensor& input_tensors,
+					  LabeledTensor& output,
+					  const std::vector<std::string>& output_names)
+	{
+		// Hold a reference to the current version for the duration of the run
+		const std::shared_ptr<const ModelInstance> instance = mpModel.load(std::memory_order_acquire);
+		if (!instance || instance->mReplicas.empty())
+			return false;
+
+		if (instance->mOutputIONamesMap.empty())
+			return false;
+
+		std::vector<std::tuple<std::string, cppflow::tensor>> inputs_vec;
+		for (const auto& [name, tensor] : input_tensors)
+		{
+			auto found = instance->mInputToIONamesMap.find(name);
+			if (found == instance->mInputToIONamesMap.end())
+			{
+				std::cerr << "Input name '" << name << "' not found in model input names." << std::endl;
+				continue;
+			}
+
+			inputs_vec.emplace_back(found->second, tensor);
+		}
+
+		// Only the requested outputs are fetched, letting the session prune the unused subgraph
+		std::vector<std::string> fetch_names;
+		for (const std::string& name : output_names)
+		{
+			auto found = instance->mOutputToIONamesMap.find(name);
+			if (found == instance->mOutputToIONamesMap.end())
+			{
+				std::cerr << "Output name '" << name << "' not found in model output names." << std::endl;
+				return false;
+			}
+
+			fetch_names.push_back(found->second);
+		}
+
+		const std::vector<std::string>& fetches = output_names.empty() ? instance->mOutputIONames : fetch_names;
+
+		const std::shared_ptr<ResultCache> cache = mpResultCache.load(std::memory_order_acquire);
+		ResultCache::Key cache_key;
+		const bool cacheable = cache && ResultCache::ComputeKey(input_tensors, output_names, instance->mVersion, cache_key);
+		if (cacheable && cache->Find(cache_key, instance->mVersion, output))
+			return true;
+
+		std::vector<cppflow::tensor> results;
+		const Session& session = *instance->mReplicas[instance->SelectReplica()];
+		if (!session.Run(inputs_vec, fetches, results))
+			return false;
+
+		LabeledTensor fetched;
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const std::string& output_name = fetches[i];
+			auto found = instance->mOutputIONamesMap.find(output_name);
+			if (found == instance->mOutputIONamesMap.end())
+			{
+				std::cerr << "Output name '" << output_name << "' not found in model output names." << std::endl;
+				continue;
+			}
+			else
+			{
+				fetched[found->second] = results[i];
+			}
+		}
+
+		// Results of a version replaced during the run are ignored by the cache
+		if (cacheable)
+			cache->Insert(cache_key, instance->mVersion, fetched);
+
+		for (auto& [name, tensor] : fetched)
+			output[name] = std::move(tensor);
+		return true;
+	}
+
+	void MLModel::SetSessionConfig(const SessionConfig& config)
+	{
+		mSessionConfig = config;
+	}
+
+	void MLModel::SetReplicaCount(uint32_t count)
+	{
+		mReplicaCount = std::max(1u, count);
+	}
+
+	void MLModel::SetWarmupConfig(const WarmupConfig& config)
+	{
+		mWarmupConfig = config;
+	}
+
+	void MLModel::SetResultCacheCapacity(size_t capacity)
+	{
+		// Created under the publish lock so that it starts at the current version
+		const std::scoped_lock lock(mModelMutex);
+		mpResultCache.store(capacity > 0 ? std::make_shared<ResultCache>(capacity, mModelVersion.load()) : nullptr, std::memory_order_release);
+	}
+
+	ResultCacheStats MLModel::GetResultCacheStats() const
+	{
+		const std::shared_ptr<ResultCache> cache = mpResultCache.load(std::memory_order_acquire);
+		if (!cache)
+			return {};
+
+		return cache->GetStats();
+	}
+
+	void MLModel::SetConversionCacheDirectory(const std::filesystem::path& directory)
+	{
+		mConversionCacheDirectory = directory.string();
+	}
+
+	void MLModel::SetUseNativeBuilder(bool enabled)
+	{
+		mUseNativeBuilder = enabled;
+	}
+
+	void MLModel::SetUsePythonWorker(bool enabled)
+	{
+		mUsePythonWorker = enabled;
+	}
+
+	void MLModel::SetPythonWorker(std::shared_ptr<PythonWorker> worker)
+	{
+		const std::scoped_lock lock(mPythonWorkerMutex);
+		mpPythonWorker = std::move(worker);
+	}
+
+	std::vector<WarmupBucket> MLModel::GetWarmupReport() const
+	{
+		const std::shared_ptr<const ModelInstance> instance = mpModel.load(std::memory_order_acquire);
+		if (!instance)
+			return {};
+
+		return instance->mWarmupReport;
+	}
+
+	void MLModel::ConfigureExecutor(const ExecutorConfig& config)
+	{
+		std::shared_ptr<TaskExecutor> previous;
+		{
+			const std::scoped_lock lock(mExecutorMutex);
+			mExecutorConfig = config;
+			previous = std::move(mpExecutor);
+		}
+
+		// The previous executor drains its queue once the last submitter releases it
+		previous.reset();
+	}
+
+	std::future<RunResult> MLModel::RunAsync(LabeledTensor input_tensors)
+	{
+		std::shared_ptr<std::promise<RunResult>> promise = std::make_shared<std::promise<RunResult>>();
+		std::future<RunResult> result = promise->get_future();
+
+		SubmitRun(std::move(input_tensors), [promise](RunResult&& run_result)
+		{
+			promise->set_value(std::move(run_result));
+		}, true);
+
+		return result;
+	}
+
+	void MLModel::RunAsync(LabeledTensor input_tensors,
+						   std::function<void(RunResult&&)> callback)
+	{
+		SubmitRun(std::move(input_tensors), std::move(callback), true);
+	}
+
+	bool MLModel::TryRunAsync(LabeledTensor input_tensors,
+							  std::future<RunResult>& result)
+	{
+		std::shared_ptr<std::promise<RunResult>> promise = std::make_shared<std::promise<RunResult>>();
+		std::future<RunResult> future = promise->get_future();
+
+		if (!SubmitRun(std::move(input_tensors), [promise](RunResult&& run_result)
+			{
+				promise->set_value(std::move(run_result));
+			}, false))
+		{
+			return false;
+		}
+
+		result = std::move(future);
+		return true;
+	}
+
+	bool MLModel::CreateRunPlan(const std::vector<std::string>& input_names,
+								const std::vector<std::string>& output_names,
+								RunPlan& plan) const
+	{
+		const std::shared_ptr<const ModelInstance> instance = mpModel.load(std::memory_order_acquire);
+		if (!instance || instance->mReplicas.empty())
+			return false;
+
+		plan = RunPlan();
+		plan.mInputNames = input_names;
+		plan.mOutputNames = output_names;
+
+		if (plan.mOutputNames.empty())
+		{
+			for (const std::string& ioName : instance->mOutputIONames)
+				plan.mOutputNames.push_back(instance->mOutputIONamesMap.at(ioName));
+		}
+
+		plan.mInputTensors.resize(plan.mInputNames.size());
+		plan.mInputValues.resize(plan.mInputNames.size());
+		plan.mOutputValues.resize(plan.mOutputNames.size());
+
+		return BindRunPlan(plan, instance);
+	}
+
+	bool MLModel::Run(RunPlan& plan,
+					  const std::vector<cppflow::tensor>& input_tensors,
+					  std::vector<cppflow::tensor>& output_tensors) const
+	{
+		if (input_tensors.size() != plan.mInputNames.size())
+		{
+			std::cerr << "Run Plan Expects " << plan.mInputNames.size() << " Inputs, Received " << input_tensors.size() << std::endl;
+			return false;
+		}
+
+		// Rebind the plan if a newer version has been published since the last run
+		std::shared_ptr<const ModelInstance> instance = mpModel.load(std::memory_order_acquire);
+		if (!instance || instance->mReplicas.empty())
+			return false;
+
+		if (instance != plan.mpInstance && !BindRunPlan(plan, std::move(instance)))
+			return false;
+
+		for (size_t i = 0; i < input_tensors.size(); ++i)
+		{
+			plan.mInputTensors[i] = input_tensors[i].get_tensor();
+			plan.mInputValues[i] = plan.mInputTensors[i].get();
+		}
+
+		const size_t replica = plan.mpInstance->SelectReplica();
+		const bool success = plan.mpInstance->mReplicas[replica]->Run(plan.mInputOps[replica].data(),
+																	  plan.mInputValues.data(),
+																	  static_cast<int>(plan.mInputValues.size()),
+																	  plan.mOutputOps[replica].data(),
+																	  plan.mOutputValues.data(),
+																	  static_cast<int>(plan.mOutputValues.size()));
+
+		// Release the input references so the plan does not extend their lifetime
+		for (std::shared_ptr<TF_Tensor>& tensor : plan.mInputTensors)
+			tensor.reset();
+
+		if (!success)
+			return false;
+
+		output_tensors.resize(plan.mOutputValues.size());
+		for (size_t i = 0; i < plan.mOutputValues.size(); ++i)
+		{
+			output_tensors[i] = cppflow::tensor(plan.mOutputValues[i]);
+			plan.mOutputValues[i] = nullptr;
+		}
+		return true;
+	}
+
+	void MLModel::ExportAll(const std::filesystem::path& directory) const
+	{
+		std::filesystem::path dir_path(directory);
+		if (!std::filesystem::exists(dir_path))
+			std::filesystem::create_directories(dir_path);
+
+		mLayout.WriteToFile(dir_path / "model_layout.json");
+		mTrainingStore.Snapshot()->WriteToFile(dir_path / "train_data.json");
+
+		std::cout << "Model and Training Data Exported to: " << dir_path << std::endl;
+	}
+
+	bool MLModel::ConvertModelToSavedModel(const std::filesystem::path& filepath,
+										   const std::filesystem::path& outputpath)
+	{
+		const std::filesystem::path converter = std::filesystem::path(mScriptDirectory) / "convert_onnx_to_saved_model.py";
+
+		std::string key;
+		if (!ConversionCache::ComputeKey(filepath, converter, key))
+		{
+			std::cerr << "Failed to Hash Model {" << filepath << "}, Converting Without Cache." << std::endl;
+			return RunOnnxConverter(filepath, outputpath);
+		}
+
+		try
+		{
+			const std::filesystem::path cache_directory = !mConversionCacheDirectory.empty() ? std::filesystem::path(mConversionCacheDirectory) : std::filesystem::path(mOutputDirectory) / "conversion_cache";
+			ConversionCache cache(cache_directory);
+
+			bool converted = false;
+			std::filesystem::path entry;
+			if (!cache.GetOrConvert(key, [&](const std::filesystem::path& staging)
+			{
+				converted = true;
+				return RunOnnxConverter(filepath, staging);
+			}, entry))
+			{
+				return false;
+			}
+
+			if (!converted)
+				std::cout << "Using Cached Conversion {" << entry.string() << "}" << std::endl;
+
+			std::filesystem::remove_all(outputpath);
+			std::filesystem::create_directories(outputpath.parent_path());
+			std::filesystem::copy(entry, outputpath, std::filesystem::copy_options::recursive);
+		}
+		catch (const std::filesystem::filesystem_error& e)
+		{
+			std::cerr << "Failed to Copy Cached Conversion: " << e.what() << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	bool MLModel::RunOnnxConverter(const std::filesystem::path& filepath,
+										   const std::filesystem::path& outputpath)
+	{
+		std::stringstream cmd;
+		cmd << "python \"" 
+			<< mScriptDirectory 
+			<< "/convert_onnx_to_saved_model.py\""
+		    << " \"" << filepath.string() << "\""
+		    << " \"" << outputpath.string() << "\"";
+
+		std::string output;
+		if (!RunPythonCommand("convert",
+							  { { "onnx_path", filepath.string() }, { "output_dir", outputpath.string() } },
+							  [&](std::string& script_output)
+							  {
+								  int32_t exit_code = std::system(cmd.str().c_str());
+								  if (exit_code != 0)
+									  script_output = "Exit code: " + std::to_string(exit_code);
+								  return exit_code == 0;
+							  },
+							  output))
+		{
+			std::cerr << "Failed to convert model to SavedModel format. " << output << std::endl;
+			return false;
+		}
+		return true;	
+	}
+
+	bool MLModel::RunPythonCommand(const std::string& command,
+								   const nlohmann::json& args,
+								   const std::function<bool(std::string&)>& fallback,
+								   std::string& output,
+								   const std::function<void(const nlohmann::json&)>& on_event)
+	{
+		if (mUsePythonWorker)
+		{
+			if (std::shared_ptr<PythonWorker> worker = GetPythonWorker())
+			{
+				nlohmann::json response;
+				const bool responded = worker->Call(command, args, response, [&](const nlohmann::json& event)
+				{
+					if (event.contains("line"))
+					{
+						const std::string line = event["line"].get<std::string>();
+						std::cout << line << std::endl;
+						output += line + "\n";
+					}
+					else if (on_event)
+					{
+						on_event(event);
+					}
+				});
+
+				if (responded)
+				{
+					if (response["status"].get<std::string>() == "ok")
+						return true;
+
+					output = response.value("error", "");
+					return false;
+				}
+
+				// The worker exited mid-command, rerun the command as a standalone script
+				std::cerr << "Python Worker unavailable, running '" << command << "' as a script." << std::endl;
+				output.clear();
+			}
+		}
+
+		if (!fallback(output))
+			return false;
+
+		if (!output.empty())
+			std::cout << output << std::endl;
+		return true;
+	}
+
+	std::shared_ptr<PythonWorker> MLModel::GetPythonWorker()
+	{
+		const std::scoped_lock lock(mPythonWorkerMutex);
+		if (mpPythonWorker && mpPythonWorker->IsAlive())
+			return mpPythonWorker;
+
+		try
+		{
+			mpPythonWorker = std::make_shared<PythonWorker>(mScriptDirectory);
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what() << std::endl;
+			mpPythonWorker = nullptr;
+		}
+		return mpPythonWorker;
+	}
+
+	std::string MLModel::GetModelRoot() const
+	{
+		return mOutputDirectory + "/" + mName;
+	}
+
+	std::string MLModel::GetCheckpointPath() const
+	{
+		return GetModelRoot() + "/train/checkpoint";
+	}
+
+	std::string MLModel::CreateModelName(int32_t version) const
+	{
+		if(version < 0)
+		{
+			return mOutputDirectory + "/" + mName + "/Saved_" + std::to_string(mModelVersion.load());
+		}
+		else
+		{
+			return mOutputDirectory + "/" + mName + "/Saved_" + std::to_string(version);
+		}
+	}
+
+	std::shared_ptr<ModelInstance> MLModel::LoadInstance(const std::string& model_path,
+														 uint32_t version,
+														 const ModelInstance* io_source) const
+	{
+		std::shared_ptr<ModelInstance> instance = std::make_shared<ModelInstance>();
+		instance->mVersion = version;
+
+		const SessionConfig replica_config = GetReplicaConfig();
+		const uint32_t replica_count = std::max(1u, mReplicaCount);
+
+		try
+		{
+			for (uint32_t i = 0; i < replica_count; ++i)
+				instance->mReplicas.push_back(std::make_shared<Session>(model_path, replica_config));
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what() << std::endl;
+			return nullptr;
+		}
+
+		// Prefer the signature read from the loaded SavedModel, then the names exported by the scripts
+		if (const SignatureDef* signature = instance->mReplicas.front()->GetSignature())
+		{
+			for (const auto& [key, ioName] : signature->mOutputs)
+			{
+				instance->mOutputIONamesMap[ioName] = key;
+				instance->mOutputToIONamesMap[key] = ioName;
+				instance->mOutputIONames.push_back(ioName);
+			}
+
+			for (const auto& [key, ioName] : signature->mInputs)
+				instance->mInputToIONamesMap[key] = ioName;
+		}
+		else if (std::ifstream in(model_path + "/cppflow_io_names.json"); in.is_open())
+		{
+			nlohmann::json io_names;
+			in >> io_names;
+
+			for (auto& [key, val] : io_names["outputs"].items())
+			{
+				const std::string ioName = val.get<std::string>();
+				instance->mOutputIONamesMap[ioName] = key;
+				instance->mOutputToIONamesMap[key] = ioName;
+				instance->mOutputIONames.push_back(ioName);
+			}
+
+			for (auto& [key, val] : io_names["inputs"].items())
+				instance->mInputToIONamesMap[key] = val.get<std::string>();
+		}
+		else if (io_source)
+		{
+			instance->mInputToIONamesMap = io_source->mInputToIONamesMap;
+			instance->mOutputIONamesMap = io_source->mOutputIONamesMap;
+			instance->mOutputToIONamesMap = io_source->mOutputToIONamesMap;
+			instance->mOutputIONames = io_source->mOutputIONames;
+		}
+		else
+		{
+			std::cerr << "No serving signature or cppflow_io_names.json found for {" << model_path << "}" << std::endl;
+			return nullptr;
+		}
+
+		if (mWarmupConfig.mEnabled)
+			WarmupInstance(*instance);
+
+		return instance;
+	}
+
+	SessionConfig MLModel::GetReplicaConfig() const
+	{
+		// Replicas split the intra-op threads between them and each own their pools
+		SessionConfig replica_config = mSessionConfig;
+		const uint32_t replica_count = std::max(1u, mReplicaCount);
+		if (replica_count > 1)
+		{
+			const uint32_t threads = mSessionConfig.mIntraOpThreads > 0 ? mSessionConfig.mIntraOpThreads : std::thread::hardware_concurrency();
+			replica_config.mIntraOpThreads = std::max(1u, threads / replica_count);
+			replica_config.mPerSessionThreads = true;
+		}
+		return replica_config;
+	}
+
+	void MLModel::WarmupInstance(ModelInstance& instance) const
+	{
+		struct InputSpec
+		{
+			std::string mIOName;
+			TF_DataType mType = TF_FLOAT;
+			std::vector<int64_t> mShape;
+		};
+
+		// Prefer the layout description, falling back to the graph for loaded models
+		std::vector<InputSpec> specs;
+		for (const auto& [name, ioName] : instance.mInputToIONamesMap)
+		{
+			InputSpec spec;
+			spec.mIOName = ioName;
+
+			auto found = std::find_if(mLayout.mInputs.begin(), mLayout.mInputs.end(), [&](const Input& input) { return input.mName == name; });
+			if (found != mLayout.mInputs.end())
+			{
+				spec.mType = ToTFDataType(found->mType);
+				spec.mShape.assign(found->mShape.begin(), found->mShape.end());
+			}
+			else if (!instance.mReplicas.front()->GetTensorSpec(ioName, spec.mType, spec.mShape))
+			{
+				std::cerr << "Skipping Warmup {" << mName << "}: Unknown Shape For Input '" << name << "'" << std::endl;
+				return;
+			}
+
+			specs.push_back(std::move(spec));
+		}
+
+		for (uint32_t batch_size : mWarmupConfig.mBatchSizes)
+		{
+			std::vector<std::tuple<std::string, cppflow::tensor>> inputs;
+			for (const InputSpec& spec : specs)
+			{
+				std::vector<int64_t> shape = spec.mShape;
+				for (size_t i = 0; i < shape.size(); ++i)
+				{
+					if (shape[i] < 0)
+						shape[i] = i == 0 ? batch_size : 1;
+				}
+
+				inputs.emplace_back(spec.mIOName, CreateZeroTensor(spec.mType, shape));
+			}
+
+			WarmupBucket bucket;
+			bucket.mBatchSize = batch_size;
+			bucket.mSuccess = true;
+
+			// Every replica pays its own optimization cost
+			const auto start_time = std::chrono::steady_clock::now();
+			for (const std::shared_ptr<Session>& replica : instance.mReplicas)
+			{
+				for (uint32_t i = 0; i < mWarmupConfig.mIterations && bucket.mSuccess; ++i)
+				{
+					std::vector<cppflow::tensor> results;
+					bucket.mSuccess = replica->Run(inputs, instance.mOutputIONames, results);
+				}
+			}
+			bucket.mDuration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time);
+
+			std::cout << "Warmup {" << mName << "} Version " << instance.mVersion 
+					  << " Batch Size " << batch_size << ": " << bucket.mDuration.count() / 1000.0 << "ms" 
+					  << (bucket.mSuccess ? "" : " (Failed)") << std::endl;
+
+			instance.mWarmupReport.push_back(bucket);
+		}
+	}
+
+	std::shared_ptr<ModelInstance> MLModel::LoadVersion(uint32_t version) const
+	{
+		const std::string model_path = CreateModelName(version);
+		if (!std::filesystem::exists(model_path))
+		{
+			std::cerr << "Model Version Does Not Exist: " << model_path << std::endl;
+			return nullptr;
+		}
+
+		const std::shared_ptr<const ModelInstance> current = mpModel.load(std::memory_order_acquire);
+		return LoadInstance(model_path, version, current.get());
+	}
+
+	bool MLModel::PublishInstance(std::shared_ptr<const ModelInstance> instance,
+								  PublishMode mode,
+								  const std::vector<uint32_t>* expected_history)
+	{
+		const uint32_t version = instance->mVersion;
+
+		// Serialize writers, readers are never blocked and release the previous version when done
+		const std::scoped_lock lock(mModelMutex);
+		if (expected_history && *expected_history != mVersionHistory)
+			return false;
+
+		mpModel.store(std::move(instance), std::memory_order_release);
+		mModelVersion = version;
+
+		const std::shared_ptr<ResultCache> cache = mpResultCache.load(std::memory_order_acquire);
+		if (cache)
+			cache->SetVersion(version);
+
+		switch (mode)
+		{
+			case PublishMode::Reset:
+				mVersionHistory = { version };
+
+				// A reset may reuse the version number of a different model
+				if (cache)
+					cache->Clear();
+				break;
+			case PublishMode::Advance:
+				mVersionHistory.push_back(version);
+				break;
+			case PublishMode::Rollback:
+				mVersionHistory.pop_back();
+				break;
+		}
+		return true;
+	}
+
+	bool MLModel::BindRunPlan(RunPlan& plan,
+							  std::shared_ptr<const ModelInstance> instance) const
+	{
+		const size_t replica_count = instance->mReplicas.size();
+		plan.mInputOps.assign(replica_count, std::vector<TF_Output>(plan.mInputNames.size()));
+		plan.mOutputOps.assign(replica_count, std::vector<TF_Output>(plan.mOutputNames.size()));
+
+		for (size_t r = 0; r < replica_count; ++r)
+		{
+			const Session& session = *instance->mReplicas[r];
+
+			for (size_t i = 0; i < plan.mInputNames.size(); ++i)
+			{
+				auto found = instance->mInputToIONamesMap.find(plan.mInputNames[i]);
+				if (found == instance->mInputToIONamesMap.end() || 
+					!session.ResolveOutput(found->second, plan.mInputOps[r][i]))
+				{
+					std::cerr << "Input name '" << plan.mInputNames[i] << "' not found in model input names." << std::endl;
+					return false;
+				}
+			}
+
+			for (size_t i = 0; i < plan.mOutputNames.size(); ++i)
+			{
+				auto found = instance->mOutputToIONamesMap.find(plan.mOutputNames[i]);
+				if (found == instance->mOutputToIONamesMap.end() ||
+					!session.ResolveOutput(found->second, plan.mOutputOps[r][i]))
+				{
+					std::cerr << "Output name '" << plan.mOutputNames[i] << "' not found in model output names." << std::endl;
+					return false;
+				}
+			}
+		}
+
+		plan.mpInstance = std::move(instance);
+		return true;
+	}
+
+	bool MLModel::SubmitRun(LabeledTensor input_tensors,
+							std::function<void(RunResult&&)> callback,
+							bool blocking)
+	{
+		std::shared_ptr<TaskExecutor> executor;
+		{
+			const std::scoped_lock lock(mExecutorMutex);
+			if (!mpExecutor)
+				mpExecutor = std::make_shared<TaskExecutor>(mExecutorConfig.mWorkerCount, mExecutorConfig.mMaxQueueDepth);
+
+			executor = mpExecutor;
+		}
+
+		// Queue depth is only known once queued, so it is shared with the task
+		std::shared_ptr<uint32_t> queue_depth = std::make_shared<uint32_t>(0);
+		const auto submit_time = std::chrono::steady_clock::now();
+
+		std::function<void()> task = [this, queue_depth, submit_time,
+									  inputs = std::move(input_tensors),
+									  callback]()
+		{
+			const auto start_time = std::chrono::steady_clock::now();
+
+			// The caller is always answered, a failed run being reported as unsuccessful
+			RunResult result;
+			try
+			{
+				result.mSuccess = Run(inputs, result.mOutput);
+			}
+			catch (const std::exception& e)
+			{
+				std::cerr << "Asynchronous run failed: " << e.what() << std::endl;
+				result = RunResult();
+			}
+			result.mQueueDepth = *queue_depth;
+			result.mQueueTime = std::chrono::duration_cast<std::chrono::microseconds>(start_time - submit_time);
+			result.mExecutionTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time);
+
+			callback(std::move(result));
+		};
+
+		const bool queued = blocking ? executor->Submit(std::move(task), queue_depth.get()) : 
+									   executor->TrySubmit(std::move(task), queue_depth.get());
+		if (!queued && blocking)
+		{
+			// The executor is shutting down, report the failed run to the caller
+			callback(RunResult());
 		}
+		return queued;
 	}
 }
\ No newline at end of file
@@ -4,15 +4,227 @@
 #include "Core/TFModelLayout.h"
 #include "Core/TFTrainingBatch.h"
 #include "Core/TFTrainingConfig.h"
+#include "Core/TFSession.h"
+#include "Core/TFTensorUtils.h"
+#include "Core/TFTrainer.h"
+
+#include "Models/MLResultCache.h"
+#include "Models/MLConversionCache.h"
+#include "Models/MLTrainingStore.h"
+
+#include "Utils/TaskExecutor.h"
+#include "Utils/PythonWorker.h"
 
 #include <vector>
 #include <filesystem>
 #include <string>
 #include <unordered_map>
 #include <mutex>
+#include <memory>
+#include <atomic>
+#include <concepts>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <span>
 
 namespace TF
 {
+	/// <summary>
+	/// Struct representing the configuration of the warmup run before a model version is published.
+	/// </summary>
+	struct WarmupConfig
+	{
+	public:
+		// Whether new versions are warmed up before being published
+		bool mEnabled = false;
+
+		// Batch sizes substituted for the dynamic batch dimension of the inputs
+		std::vector<uint32_t> mBatchSizes = { 1 };
+
+		// Number of runs per batch size
+		uint32_t mIterations = 1;
+	};
+
+	/// <summary>
+	/// Struct representing the warmup result of a single batch size.
+	/// </summary>
+	struct WarmupBucket
+	{
+	public:
+		uint32_t mBatchSize = 0;
+		bool mSuccess = false;
+		std::chrono::microseconds mDuration = std::chrono::microseconds(0);
+	};
+
+	/// <summary>
+	/// Struct representing a published version of a model. Instances are immutable once published,
+	/// allowing in-flight runs to keep using a version while a newer one is swapped in.
+	/// </summary>
+	struct ModelInstance
+	{
+	public:
+		/// <summary>
+		/// Selects the replica with the fewest in-flight runs.
+		/// </summary>
+		/// <returns>The replica index</returns>
+		size_t SelectReplica() const;
+	public:
+		uint32_t mVersion = 0;
+
+		// Sessions of the same version, each with its own thread pools
+		std::vector<std::shared_ptr<Session>> mReplicas;
+
+		std::unordered_map<std::string, std::string> mInputToIONamesMap;
+		std::unordered_map<std::string, std::string> mOutputIONamesMap;
+		std::unordered_map<std::string, std::string> mOutputToIONamesMap;
+		std::vector<std::string> mOutputIONames;
+
+		std::vector<WarmupBucket> mWarmupReport;
+	};
+
+	/// <summary>
+	/// Struct representing the result of a deferred model run.
+	/// </summary>
+	struct RunResult
+	{
+	public:
+		bool mSuccess = false;
+
+		std::unordered_map<std::string, cppflow::tensor> mOutput;
+
+		// Number of queued requests when the request was submitted
+		uint32_t mQueueDepth = 0;
+
+		// Time spent waiting in the queue
+		std::chrono::microseconds mQueueTime = std::chrono::microseconds(0);
+
+		// Time spent running the model
+		std::chrono::microseconds mExecutionTime = std::chrono::microseconds(0);
+	};
+
+	/// <summary>
+	/// Struct representing the configuration of the asynchronous run executor.
+	/// </summary>
+	struct ExecutorConfig
+	{
+	public:
+		// Number of worker threads, hardware concurrency if zero
+		uint32_t mWorkerCount = 0;
+
+		// Maximum number of queued requests before submission applies backpressure
+		uint32_t mMaxQueueDepth = 256;
+	};
+
+	/// <summary>
+	/// Class representing a precompiled set of model inputs/outputs. The graph operations
+	/// and slot indices are resolved once so runs avoid any name lookups or allocations.
+	///
+	/// A plan is rebound automatically when the model version changes, and must not be
+	/// run concurrently from multiple threads.
+	/// </summary>
+	class RunPlan
+	{
+	public:
+		/// <summary>
+		/// Retrieves the input names in slot order.
+		/// </summary>
+		/// <returns>The input names</returns>
+		const std::vector<std::string>& GetInputNames() const { return mInputNames; }
+
+		/// <summary>
+		/// Retrieves the output names in slot order.
+		/// </summary>
+		/// <returns>The output names</returns>
+		const std::vector<std::string>& GetOutputNames() const { return mOutputNames; }
+	private:
+		friend class MLModel;
+
+		std::vector<std::string> mInputNames;
+		std::vector<std::string> mOutputNames;
+
+		// Model version the graph operations were resolved against
+		std::shared_ptr<const ModelInstance> mpInstance = nullptr;
+
+		// Graph operations per replica, as each replica owns a separate graph
+		std::vector<std::vector<TF_Output>> mInputOps;
+		std::vector<std::vector<TF_Output>> mOutputOps;
+
+		std::vector<std::shared_ptr<TF_Tensor>> mInputTensors;
+		std::vector<TF_Tensor*> mInputValues;
+		std::vector<TF_Tensor*> mOutputValues;
+	};
+
+	/// <summary>
+	/// Class representing a training running in the background. The current version keeps
+	/// serving runs until the trained version is published on completion.
+	/// </summary>
+	class TrainingJob
+	{
+	public:
+		/// <summary>
+		/// Requests the training to stop. A cancelled training publishes no version.
+		/// </summary>
+		void Cancel();
+
+		bool IsCancelled() const { return mCancelled.load(std::memory_order_relaxed); }
+
+		/// <summary>
+		/// Checks whether the training has completed, successfully or not.
+		/// </summary>
+		/// <returns>True if the training has completed</returns>
+		bool IsDone() const;
+
+		/// <summary>
+		/// Waits for the training to complete.
+		/// </summary>
+		/// <returns>True if the trained version was published</returns>
+		bool Wait() const;
+
+		/// <summary>
+		/// Waits for the training to complete, up to the given timeout.
+		/// </summary>
+		/// <param name="timeout">The maximum waiting time</param>
+		/// <returns>True if the training has completed</returns>
+		bool WaitFor(std::chrono::milliseconds timeout) const;
+
+		/// <summary>
+		/// Retrieves the progress of the last completed epoch.
+		/// </summary>
+		/// <returns>The training progress</returns>
+		TrainingProgress GetProgress() const;
+	private:
+		friend class MLModel;
+
+		/// <summary>
+		/// Records the progress of an epoch and forwards it to the progress callback.
+		/// </summary>
+		/// <param name="progress">The training progress</param>
+		void ReportProgress(const TrainingProgress& progress);
+
+		/// <summary>
+		/// Completes the job, removing its cancel file.
+		/// </summary>
+		/// <param name="trained">Whether the trained version was published</param>
+		void Finish(bool trained);
+	private:
+		TrainingCallback mOnProgress = nullptr;
+
+		// Flag file polled by the Python training script, unique to the job so cancelling it leaves other trainings running
+		std::filesystem::path mCancelPath;
+		std::atomic<bool> mCancelled = false;
+
+		// Keeps a cancel from recreating the cancel file of a finished job
+		std::mutex mCancelMutex = {};
+		bool mFinished = false;
+
+		std::promise<bool> mPromise;
+		std::shared_future<bool> mResult = mPromise.get_future().share();
+
+		mutable std::mutex mProgressMutex = {};
+		TrainingProgress mProgress;
+	};
+
 	/// <summary>
 	/// Class representing a Machine Learning Model that can be used for training and inference.
 	/// </summary>
@@ -69,17 +281,68 @@ namespace TF
 					  const std::unordered_map<std::string, nlohmann::json>& params);
 
 		/// <summary>
-		/// Adds training data to the model.
+		/// Adds training data to the model. Training data may be added from any number of threads
+		/// at once, including while the model trains on a snapshot of the data added so far.
 		/// </summary>
 		/// <param name="input_name">The input name of the training batch</param>
 		/// <param name="input_values">The input values</param>
 		/// <param name="label_name">The label name of the training batch</param>
 		/// <param name="label_outputs">The label outputs</param>
-		void AddTrainingData(const std::string& input_name, 
+		/// <returns>True if the values match the type and shape of the input and label</returns>
+		bool AddTrainingData(const std::string& input_name, 
 						     const nlohmann::json& input_values,
 						     const std::string& label_name,
 						     const nlohmann::json& label_outputs);
 
+		/// <summary>
+		/// Adds a batch of training samples from contiguous buffers, sample after sample,
+		/// converted if the types differ from the input and label columns.
+		/// </summary>
+		/// <param name="input_name">The input name of the training batch</param>
+		/// <param name="input_values">The input values of every sample</param>
+		/// <param name="label_name">The label name of the training batch</param>
+		/// <param name="label_outputs">The label outputs of every sample</param>
+		/// <param name="sample_count">The number of samples</param>
+		/// <returns>True if the buffers hold sample_count samples of the input and label shapes</returns>
+		template<typename TInput, typename TLabel>
+		bool AddTrainingData(const std::string& input_name,
+							 std::span<const TInput> input_values,
+							 const std::string& label_name,
+							 std::span<const TLabel> label_outputs,
+							 size_t sample_count);
+
+		/// <summary>
+		/// Adds a batch of training samples, moving the buffers in. A buffer is adopted without
+		/// copying when it is the first data of its column and has the column data type.
+		/// </summary>
+		/// <param name="input_name">The input name of the training batch</param>
+		/// <param name="input_values">The input values of every sample</param>
+		/// <param name="label_name">The label name of the training batch</param>
+		/// <param name="label_outputs">The label outputs of every sample</param>
+		/// <param name="sample_count">The number of samples</param>
+		/// <returns>True if the buffers hold sample_count samples of the input and label shapes</returns>
+		template<typename TInput, typename TLabel>
+		bool AddTrainingData(const std::string& input_name,
+							 std::vector<TInput>&& input_values,
+							 const std::string& label_name,
+							 std::vector<TLabel>&& label_outputs,
+							 size_t sample_count);
+
+		/// <summary>
+		/// Adds a batch of training samples from tensors batched along their first dimension.
+		/// A template only so braced lists keep resolving to the JSON overload.
+		/// </summary>
+		/// <param name="input_name">The input name of the training batch</param>
+		/// <param name="input_values">The input tensor</param>
+		/// <param name="label_name">The label name of the training batch</param>
+		/// <param name="label_outputs">The label tensor</param>
+		/// <returns>True if the tensors hold the same number of samples of the input and label shapes</returns>
+		template<typename Tensor> requires std::same_as<Tensor, cppflow::tensor>
+		bool AddTrainingData(const std::string& input_name,
+							 const Tensor& input_values,
+							 const std::string& label_name,
+							 const Tensor& label_outputs);
+
 		/// <summary>
 		/// Save the model layout to a JSON file.
 		/// </summary>
@@ -92,16 +355,23 @@ namespace TF
 		/// <param name="path">The output path of the json file</param>
 		void SaveTrainingJson(const std::filesystem::path& path) const;
 
+		/// <summary>
+		/// Save the training data to a binary columnar file, as read by train_model_from_json.py.
+		/// </summary>
+		/// <param name="path">The output path of the binary file</param>
+		void SaveTrainingBinary(const std::filesystem::path& path) const;
+
 		/// <summary>
 		/// Creates the model based on the current layout and training data.
+		/// The previous build is reused if it was built from an identical layout.
 		/// </summary>
+		/// <param name="force_rebuild">Whether to rebuild even if the layout is unchanged</param>
 		/// <returns>True if the creation was successful</returns>
-		bool CreateModel();
+		bool CreateModel(bool force_rebuild = false);
 
 		/// <summary>
-		/// Launches the training of the model.
+		/// Launches the training of the model, see TrainModel(const TrainingConfig&).
 		/// </summary>
-		/// <param name="output_path">The output path of the model</param>
 		/// <param name="epochs">The number of epochs</param>
 		/// <param name="batchSize">The batch size</param>
 		/// <param name="learning_rate">The learning rate</param>
@@ -114,6 +384,56 @@ namespace TF
 						bool shuffle = true,
 						float validation_split = 0.0f);
 
+		/// <summary>
+		/// Trains the current version on the training data and publishes the result as a new version.
+		/// Natively built models are trained in-process through the TensorFlow C API, continuing from
+		/// the weights in memory, and are published without reloading; the save is then optional.
+		/// Other models are trained by train_model_from_json.py.
+		/// </summary>
+		/// <param name="config">The training configuration</param>
+		/// <returns>True if the training was successful</returns>
+		bool TrainModel(const TrainingConfig& config);
+
+		/// <summary>
+		/// Launches the training on a background thread, see TrainModel(const TrainingConfig&).
+		/// The training uses a snapshot of the training store taken when called, and the current
+		/// version keeps serving runs until the trained version is published. Concurrent trainings
+		/// run one at a time.
+		/// </summary>
+		/// <param name="config">The training configuration</param>
+		/// <param name="on_progress">Optional callback receiving the progress after each epoch, called from the training thread. Python trainings report it through the worker, or through the script output as it runs</param>
+		/// <returns>The handle of the training</returns>
+		std::shared_ptr<TrainingJob> TrainModelAsync(const TrainingConfig& config,
+													 TrainingCallback on_progress = nullptr);
+
+		/// <summary>
+		/// Loads the given version from its Saved_N directory and publishes it once loaded
+		/// (and warmed up). Runs keep being served by the current version in the meantime.
+		/// </summary>
+		/// <param name="version">The version number</param>
+		/// <returns>True if the version was loaded and published</returns>
+		bool PublishVersion(uint32_t version);
+
+		/// <summary>
+		/// Loads and publishes the given version on a background thread.
+		/// When multiple loads overlap, the last one to complete is published.
+		/// </summary>
+		/// <param name="version">The version number</param>
+		/// <returns>The future publish result, destroying it waits for the load to complete</returns>
+		std::future<bool> PublishVersionAsync(uint32_t version);
+
+		/// <summary>
+		/// Republishes the version that was published before the current one.
+		/// </summary>
+		/// <returns>True if a previous version exists and was published</returns>
+		bool RollbackVersion();
+
+		/// <summary>
+		/// Retrieves the versions saved under the model root.
+		/// </summary>
+		/// <returns>The sorted version numbers</returns>
+		std::vector<uint32_t> GetAvailableVersions() const;
+
 		/// <summary>
 		/// Runs the model with the given input tensors and returns the output.
 		/// </summary>
@@ -123,6 +443,143 @@ namespace TF
 		bool Run(const LabeledTensor& input_tensors,
 				 LabeledTensor& output);
 
+		/// <summary>
+		/// Runs the model with the given input tensors, fetching only the requested outputs.
+		/// Unrequested outputs are pruned from the graph and never computed.
+		/// </summary>
+		/// <param name="input_tensors">The input tensors</param>
+		/// <param name="output">The output result</param>
+		/// <param name="output_names">The output names to fetch, all outputs if empty</param>
+		/// <returns>True if the running the model was successful</returns>
+		bool Run(const LabeledTensor& input_tensors,
+				 LabeledTensor& output,
+				 const std::vector<std::string>& output_names);
+
+		/// <summary>
+		/// Enables a least recently used cache of run results keyed by a hash of the input tensors,
+		/// so repeated inputs skip the session run. The cache is emptied whenever another version
+		/// is published. Cached output tensors are shared between callers and must not be modified.
+		/// </summary>
+		/// <param name="capacity">The maximum number of cached results, 0 disables the cache</param>
+		void SetResultCacheCapacity(size_t capacity);
+
+		/// <summary>
+		/// Retrieves the hit/miss counters of the result cache.
+		/// </summary>
+		/// <returns>The counters, all zero if the cache is disabled</returns>
+		ResultCacheStats GetResultCacheStats() const;
+
+		/// <summary>
+		/// Sets the threading and optimizer configuration used by subsequently loaded versions.
+		/// Use SessionConfig::Auto to size the thread pools for the machine.
+		/// </summary>
+		/// <param name="config">The session configuration</param>
+		void SetSessionConfig(const SessionConfig& config);
+
+		/// <summary>
+		/// Sets the number of session replicas held per version. Runs are dispatched to the
+		/// least loaded replica, and each replica gets an equal share of the intra-op threads.
+		/// </summary>
+		/// <param name="count">The number of replicas</param>
+		void SetReplicaCount(uint32_t count);
+
+		/// <summary>
+		/// Sets the warmup applied to newly created, loaded or trained versions before they are published.
+		/// Like the layout setters, this should not be called while a model update is in progress.
+		/// </summary>
+		/// <param name="config">The warmup configuration</param>
+		void SetWarmupConfig(const WarmupConfig& config);
+
+		/// <summary>
+		/// Retrieves the warmup timings of the currently published version.
+		/// </summary>
+		/// <returns>The time spent per warmup batch size</returns>
+		std::vector<WarmupBucket> GetWarmupReport() const;
+
+		/// <summary>
+		/// Sets the directory caching ONNX to SavedModel conversions, shared safely between processes.
+		/// Defaults to "conversion_cache" under the output directory.
+		/// </summary>
+		/// <param name="directory">The cache directory</param>
+		void SetConversionCacheDirectory(const std::filesystem::path& directory);
+
+		/// <summary>
+		/// Sets whether CreateModel builds the layout natively through the TensorFlow C API
+		/// instead of running build_model_from_json.py. Natively built models are plain graphs
+		/// rather than Keras models, so they cannot be trained by the Python training script.
+		/// </summary>
+		/// <param name="enabled">Whether to use the native builder</param>
+		void SetUseNativeBuilder(bool enabled);
+
+		/// <summary>
+		/// Sets whether model creation, training, loading and conversion are run by a persistent
+		/// Python worker instead of a new interpreter per operation. Disabled by default. When
+		/// enabled, the worker is started on first use and the scripts are run directly if it
+		/// cannot be started.
+		/// </summary>
+		/// <param name="enabled">Whether to use the Python worker</param>
+		void SetUsePythonWorker(bool enabled);
+
+		/// <summary>
+		/// Sets the Python worker used by the model, allowing a single worker to be shared between models.
+		/// </summary>
+		/// <param name="worker">The Python worker</param>
+		void SetPythonWorker(std::shared_ptr<PythonWorker> worker);
+
+		/// <summary>
+		/// Configures the worker pool used by the asynchronous runs.
+		/// Requests already queued on a previous executor are completed first.
+		/// </summary>
+		/// <param name="config">The executor configuration</param>
+		void ConfigureExecutor(const ExecutorConfig& config);
+
+		/// <summary>
+		/// Queues a run on the worker pool, blocking only while the queue is full.
+		/// </summary>
+		/// <param name="input_tensors">The input tensors</param>
+		/// <returns>The future result of the run</returns>
+		std::future<RunResult> RunAsync(LabeledTensor input_tensors);
+
+		/// <summary>
+		/// Queues a run on the worker pool, blocking only while the queue is full.
+		/// The callback is invoked on a worker thread once the run completes.
+		/// </summary>
+		/// <param name="input_tensors">The input tensors</param>
+		/// <param name="callback">The completion callback</param>
+		void RunAsync(LabeledTensor input_tensors,
+					  std::function<void(RunResult&&)> callback);
+
+		/// <summary>
+		/// Queues a run on the worker pool without blocking.
+		/// </summary>
+		/// <param name="input_tensors">The input tensors</param>
+		/// <param name="result">The future result of the run</param>
+		/// <returns>True if the run was queued, false if the queue is full</returns>
+		bool TryRunAsync(LabeledTensor input_tensors,
+						 std::future<RunResult>& result);
+
+		/// <summary>
+		/// Creates a run plan binding the given inputs/outputs to fixed slot indices.
+		/// </summary>
+		/// <param name="input_names">The input names in slot order</param>
+		/// <param name="output_names">The output names in slot order, all outputs if empty</param>
+		/// <param name="plan">The created run plan</param>
+		/// <returns>True if all of the names could be resolved</returns>
+		bool CreateRunPlan(const std::vector<std::string>& input_names,
+						   const std::vector<std::string>& output_names,
+						   RunPlan& plan) const;
+
+		/// <summary>
+		/// Runs the model through a precompiled run plan.
+		/// </summary>
+		/// <param name="plan">The run plan</param>
+		/// <param name="input_tensors">The input tensors in the plan's input slot order</param>
+		/// <param name="output_tensors">The output tensors in the plan's output slot order</param>
+		/// <returns>True if the running the model was successful</returns>
+		bool Run(RunPlan& plan,
+				 const std::vector<cppflow::tensor>& input_tensors,
+				 std::vector<cppflow::tensor>& output_tensors) const;
+
 		/// <summary>
 		/// Exports all of the model's components to the specified directory.
 		/// </summary>
@@ -131,6 +588,7 @@ namespace TF
 	private:
 		/// <summary>
 		/// Converts the model to a SavedModel format if it is not already in that format.
+		/// Conversions are cached by the contents of the model and the converter script.
 		/// </summary>
 		/// <param name="filepath">The input model's filepath</param>
 		/// <param name="outputpath">The output model path</param>
@@ -138,12 +596,123 @@ namespace TF
 		bool ConvertModelToSavedModel(const std::filesystem::path& filepath,
 									  const std::filesystem::path& outputpath);
 
+		/// <summary>
+		/// Trains the current version on a training batch, natively if the version supports it.
+		/// </summary>
+		/// <param name="config">The training configuration</param>
+		/// <param name="batch">The training data</param>
+		/// <param name="job">Optional job receiving the progress and requesting cancellation</param>
+		/// <returns>True if the training was successful</returns>
+		bool RunTraining(const TrainingConfig& config,
+						 const TrainingBatch& batch,
+						 TrainingJob* job);
+
+		/// <summary>
+		/// Trains a natively built version in-process and publishes the trained weights.
+		/// </summary>
+		/// <param name="config">The training configuration</param>
+		/// <param name="batch">The training data</param>
+		/// <param name="instance">The trained version</param>
+		/// <param name="next_version">The version number of the trained model</param>
+		/// <param name="job">Optional job receiving the progress and requesting cancellation</param>
+		/// <returns>True if the training was successful</returns>
+		bool TrainModelNative(const TrainingConfig& config,
+							  const TrainingBatch& batch,
+							  const std::shared_ptr<const ModelInstance>& instance,
+							  uint32_t next_version,
+							  TrainingJob* job);
+
+		/// <summary>
+		/// Trains the current version with train_model_from_json.py and publishes the saved result.
+		/// </summary>
+		/// <param name="config">The training configuration</param>
+		/// <param name="batch">The training data</param>
+		/// <param name="next_version">The version number of the trained model</param>
+		/// <param name="job">Optional job receiving the progress and requesting cancellation</param>
+		/// <returns>True if the training was successful</returns>
+		bool TrainModelPython(const TrainingConfig& config,
+							  const TrainingBatch& batch,
+							  uint32_t next_version,
+							  TrainingJob* job);
+
+		/// <summary>
+		/// Retrieves the version number for a newly trained model, after every saved or published version.
+		/// </summary>
+		/// <returns>The version number</returns>
+		uint32_t GetNextVersion() const;
+
+		/// <summary>
+		/// Retrieves the number of epochs stored by the last checkpoint of a version's training.
+		/// </summary>
+		/// <param name="version">The trained version</param>
+		/// <returns>The checkpoint epoch, 0 if no checkpoint of the version exists</returns>
+		uint32_t GetCheckpointEpoch(uint32_t version) const;
+
+		/// <summary>
+		/// Saves the weights of the native trainer as the training checkpoint of a version.
+		/// </summary>
+		/// <param name="version">The trained version</param>
+		/// <param name="epoch">The number of completed epochs</param>
+		/// <returns>True if the checkpoint was written</returns>
+		bool WriteCheckpoint(uint32_t version,
+							 uint32_t epoch) const;
+
+		/// <summary>
+		/// Retrieves the session configuration of each replica, splitting the intra-op threads between them.
+		/// </summary>
+		/// <returns>The replica session configuration</returns>
+		SessionConfig GetReplicaConfig() const;
+
+		/// <summary>
+		/// Builds the layout by running build_model_from_json.py into the first version folder.
+		/// </summary>
+		/// <param name="model_path_root">The model root directory holding model_description.json</param>
+		/// <returns>True if the model was built</returns>
+		bool BuildModelWithPython(const std::string& model_path_root);
+
+		/// <summary>
+		/// Runs a command on the Python worker, streaming its output to the console. If the worker
+		/// is disabled or not running, the fallback running the equivalent script is used instead.
+		/// </summary>
+		/// <param name="command">The worker command</param>
+		/// <param name="args">The command arguments</param>
+		/// <param name="fallback">The fallback running the script in a new interpreter</param>
+		/// <param name="output">The captured output or error</param>
+		/// <param name="on_event">Optional callback receiving the worker events other than log lines</param>
+		/// <returns>True if the command was successful</returns>
+		bool RunPythonCommand(const std::string& command,
+							  const nlohmann::json& args,
+							  const std::function<bool(std::string&)>& fallback,
+							  std::string& output,
+							  const std::function<void(const nlohmann::json&)>& on_event = nullptr);
+
+		/// <summary>
+		/// Retrieves the Python worker, starting it if it is not running.
+		/// </summary>
+		/// <returns>The Python worker or nullptr if it could not be started</returns>
+		std::shared_ptr<PythonWorker> GetPythonWorker();
+
+		/// <summary>
+		/// Runs the ONNX to SavedModel converter script.
+		/// </summary>
+		/// <param name="filepath">The input model's filepath</param>
+		/// <param name="outputpath">The output model path</param>
+		/// <returns>True if conversion was successful</returns>
+		bool RunOnnxConverter(const std::filesystem::path& filepath,
+							  const std::filesystem::path& outputpath);
+
 		/// <summary>
 		/// Retrieves the root directory for the model based on the output directory and model name.
 		/// </summary>
 		/// <returns>The model root directory</returns>
 		std::string GetModelRoot() const;
 
+		/// <summary>
+		/// Retrieves the directory of the training checkpoint, shared with train_model_from_json.py.
+		/// </summary>
+		/// <returns>The checkpoint directory</returns>
+		std::string GetCheckpointPath() const;
+
 		/// <summary>
 		/// Creates a model name based on the model number based on the input parameter.
 		/// If the version is -1, it will use the current model version.
@@ -151,23 +720,173 @@ namespace TF
 		/// <param name="version">Version number override</param>
 		/// <returns>The version model name</returns>
 		std::string CreateModelName(int32_t version = -1) const;
+
+		/// <summary>
+		/// Loads the model version at the given path along with its input/output names, read from
+		/// the SavedModel's serving signature or else from its exported cppflow_io_names.json.
+		/// </summary>
+		/// <param name="model_path">The SavedModel path of the version</param>
+		/// <param name="version">The version number</param>
+		/// <param name="io_source">Optional instance to copy the input/output names from if the version has none</param>
+		/// <returns>The loaded model instance or nullptr if the load failed</returns>
+		std::shared_ptr<ModelInstance> LoadInstance(const std::string& model_path,
+													uint32_t version,
+													const ModelInstance* io_source = nullptr) const;
+
+		/// <summary>
+		/// Runs synthetic inputs through a model instance for each configured batch size,
+		/// paying the graph optimization and kernel selection cost ahead of serving.
+		/// </summary>
+		/// <param name="instance">The model instance</param>
+		void WarmupInstance(ModelInstance& instance) const;
+
+		/// <summary>
+		/// Loads the model version from its Saved_N directory. Versions saved without
+		/// their own input/output names reuse the names of the current version.
+		/// </summary>
+		/// <param name="version">The version number</param>
+		/// <returns>The loaded model instance or nullptr if the load failed</returns>
+		std::shared_ptr<ModelInstance> LoadVersion(uint32_t version) const;
+
+		/// <summary>
+		/// Enum representing how a publish affects the version history.
+		/// </summary>
+		enum class PublishMode
+		{
+			Reset,
+			Advance,
+			Rollback
+		};
+
+		/// <summary>
+		/// Atomically publishes a model instance to be used by subsequent runs.
+		/// </summary>
+		/// <param name="instance">The model instance</param>
+		/// <param name="mode">How the publish affects the version history</param>
+		/// <param name="expected_history">Optional version history the publish was prepared against, checked under the publish lock</param>
+		/// <returns>True if published, false if the version history no longer matches the expected one</returns>
+		bool PublishInstance(std::shared_ptr<const ModelInstance> instance,
+							 PublishMode mode = PublishMode::Advance,
+							 const std::vector<uint32_t>* expected_history = nullptr);
+
+		/// <summary>
+		/// Resolves the graph operations of a run plan against the given model version.
+		/// </summary>
+		/// <param name="plan">The run plan</param>
+		/// <param name="instance">The model version</param>
+		/// <returns>True if all of the plan's names could be resolved</returns>
+		bool BindRunPlan(RunPlan& plan,
+						 std::shared_ptr<const ModelInstance> instance) const;
+
+		/// <summary>
+		/// Submits a run to the worker pool, creating the pool on first use.
+		/// </summary>
+		/// <param name="input_tensors">The input tensors</param>
+		/// <param name="callback">The completion callback</param>
+		/// <param name="blocking">Whether to block while the queue is full</param>
+		/// <returns>True if the run was queued</returns>
+		bool SubmitRun(LabeledTensor input_tensors,
+					   std::function<void(RunResult&&)> callback,
+					   bool blocking);
 	public:
 		std::string mName;
 		std::atomic<uint32_t> mModelVersion = 0;
 
-		std::unique_ptr<cppflow::model> mpModel = nullptr;
+		// Current published model, read lock-free by Run and swapped by model updates
+		std::atomic<std::shared_ptr<const ModelInstance>> mpModel = nullptr;
+
+		// Serializes model updates, never taken by Run
 		std::mutex mModelMutex = {};
 
+		// Previously published versions, most recent last
+		std::vector<uint32_t> mVersionHistory;
+
 		std::string mScriptDirectory;
 		std::string mOutputDirectory;
+		std::string mConversionCacheDirectory;
 
 
 		ModelLayout mLayout;
 
-		std::unordered_map<std::string, std::string> mInputToIONamesMap;
-		std::unordered_map<std::string, std::string> mOutputIONamesMap;
-		std::vector<std::string> mOutputIONames;
+		SessionConfig mSessionConfig;
+		uint32_t mReplicaCount = 1;
+		WarmupConfig mWarmupConfig;
+
+		// Optional cache of run results, nullptr when disabled
+		std::atomic<std::shared_ptr<ResultCache>> mpResultCache = nullptr;
+
+		// Training data, added concurrently and snapshotted by each training
+		TrainingStore mTrainingStore;
+
+		// Trainer of natively built models, holding the weights of the version it last trained
+		std::shared_ptr<Trainer> mpTrainer = nullptr;
+		uint32_t mTrainerVersion = 0;
+		std::string mTrainerSourcePath;
+		std::mutex mTrainingMutex = {};
+
+		bool mUseNativeBuilder = false;
+		bool mUsePythonWorker = false;
+		std::shared_ptr<PythonWorker> mpPythonWorker = nullptr;
+		std::mutex mPythonWorkerMutex = {};
+
+		ExecutorConfig mExecutorConfig;
+		std::mutex mExecutorMutex = {};
+
+		// Declared after the state used by runs, so queued runs are drained before it is destroyed
+		std::shared_ptr<TaskExecutor> mpExecutor = nullptr;
 
-		TrainingBatch mCurrentTrainingBatch;
+		// Background trainings, declared last so they are waited for first when the model is destroyed
+		std::mutex mTrainingTasksMutex = {};
+		std::vector<std::future<void>> mTrainingTasks;
 	};
-}
\ No newline at end of file
+
+	template<typename TInput, typename TLabel>
+	bool MLModel::AddTrainingData(const std::string& input_name,
+								  std::span<const TInput> input_values,
+								  const std::string& label_name,
+								  std::span<const TLabel> label_outputs,
+								  size_t sample_count)
+	{
+		// Without a known shape, each sample is a flat row
+		const auto flat_shape = [&](size_t size) { return std::vector<int64_t>{ static_cast<int64_t>(sample_count > 0 ? size / sample_count : 0) }; };
+
+		return mTrainingStore.Add([&](TrainingBatch& batch)
+		{
+			return batch.AddSamples(input_name, label_name, mLayout,
+				[&](TrainingColumn& input) { return input.Append(input_values, sample_count, flat_shape(input_values.size())); },
+				[&](TrainingColumn& label) { return label.Append(label_outputs, sample_count, flat_shape(label_outputs.size())); });
+		});
+	}
+
+	template<typename TInput, typename TLabel>
+	bool MLModel::AddTrainingData(const std::string& input_name,
+								  std::vector<TInput>&& input_values,
+								  const std::string& label_name,
+								  std::vector<TLabel>&& label_outputs,
+								  size_t sample_count)
+	{
+		const std::vector<int64_t> input_shape = { static_cast<int64_t>(sample_count > 0 ? input_values.size() / sample_count : 0) };
+		const std::vector<int64_t> label_shape = { static_cast<int64_t>(sample_count > 0 ? label_outputs.size() / sample_count : 0) };
+
+		return mTrainingStore.Add([&](TrainingBatch& batch)
+		{
+			return batch.AddSamples(input_name, label_name, mLayout,
+				[&](TrainingColumn& input) { return input.Append(std::move(input_values), sample_count, input_shape); },
+				[&](TrainingColumn& label) { return label.Append(std::move(label_outputs), sample_count, label_shape); });
+		});
+	}
+
+	template<typename Tensor> requires std::same_as<Tensor, cppflow::tensor>
+	bool MLModel::AddTrainingData(const std::string& input_name,
+								  const Tensor& input_values,
+								  const std::string& label_name,
+								  const Tensor& label_outputs)
+	{
+		return mTrainingStore.Add([&](TrainingBatch& batch)
+		{
+			return batch.AddSamples(input_name, label_name, mLayout,
+				[&](TrainingColumn& input) { return AppendTensorToColumn(input_values, input); },
+				[&](TrainingColumn& label) { return AppendTensorToColumn(label_outputs, label); });
+		});
+	}
+}
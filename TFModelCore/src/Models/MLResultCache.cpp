@@ -0,0 +1,154 @@
+#include "Models/MLResultCache.h"
+
+#include "Core/TFTensorUtils.h"
+
+#include "Utils/HashUtils.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace TF
+{
+	ResultCache::ResultCache(size_t capacity,
+							 uint32_t version)
+		: mCapacity(capacity),
+		mVersion(version)
+	{
+		if (mCapacity == 0)
+			throw std::invalid_argument("Result Cache capacity must be greater than zero.");
+
+		mIndex.reserve(mCapacity);
+	}
+
+	bool ResultCache::ComputeKey(const std::unordered_map<std::string, cppflow::tensor>& input_tensors,
+								 const std::vector<std::string>& output_names,
+								 uint32_t version,
+								 Key& key)
+	{
+		// The map iteration order is unspecified, so inputs are hashed in name order
+		std::vector<const std::pair<const std::string, cppflow::tensor>*> inputs;
+		inputs.reserve(input_tensors.size());
+		for (const auto& input : input_tensors)
+		{
+			if (input.second.dtype() == TF_STRING)
+				return false;
+
+			inputs.push_back(&input);
+		}
+
+		std::sort(inputs.begin(), inputs.end(), [](const auto* a, const auto* b)
+		{
+			return a->first < b->first;
+		});
+
+		// Names are length-prefixed so different inputs never serialize to the same bytes
+		const auto AppendName = [&](const std::string& name)
+		{
+			const uint64_t size = name.size();
+			key.mBytes.append(reinterpret_cast<const char*>(&size), sizeof(size));
+			key.mBytes.append(name);
+		};
+
+		key.mBytes.clear();
+		key.mBytes.append(reinterpret_cast<const char*>(&version), sizeof(version));
+		for (const auto* input : inputs)
+		{
+			AppendName(input->first);
+			AppendTensorBytes(input->second, key.mBytes);
+		}
+
+		// Different output selections of the same inputs are cached separately
+		for (const std::string& name : output_names)
+			AppendName(name);
+
+		key.mHash = HashUtils::HashBytes(key.mBytes.data(), key.mBytes.size());
+		return true;
+	}
+
+	bool ResultCache::Find(const Key& key,
+						   uint32_t version,
+						   Outputs& output)
+	{
+		const std::scoped_lock lock(mMutex);
+
+		// A replaced version, or a hash collision with other inputs, is a miss
+		auto found = mIndex.find(key.mHash);
+		if (version != mVersion || found == mIndex.end() || found->second->mKey.mBytes != key.mBytes)
+		{
+			++mMisses;
+			return false;
+		}
+
+		mEntries.splice(mEntries.begin(), mEntries, found->second);
+		for (const auto& [name, tensor] : found->second->mOutput)
+			output[name] = tensor;
+
+		++mHits;
+		return true;
+	}
+
+	void ResultCache::Insert(const Key& key,
+							 uint32_t version,
+							 const Outputs& output)
+	{
+		const std::scoped_lock lock(mMutex);
+		if (version != mVersion)
+			return;
+
+		auto found = mIndex.find(key.mHash);
+		if (found != mIndex.end())
+		{
+			// A concurrent miss on the same inputs already stored the result
+			if (found->second->mKey.mBytes == key.mBytes)
+			{
+				mEntries.splice(mEntries.begin(), mEntries, found->second);
+				return;
+			}
+
+			// Other inputs with the same hash are replaced by the most recent ones
+			mEntries.erase(found->second);
+			mIndex.erase(found);
+		}
+
+		if (mEntries.size() >= mCapacity)
+		{
+			mIndex.erase(mEntries.back().mKey.mHash);
+			mEntries.pop_back();
+			++mEvictions;
+		}
+
+		mEntries.push_front({ key, output });
+		mIndex.emplace(key.mHash, mEntries.begin());
+	}
+
+	void ResultCache::SetVersion(uint32_t version)
+	{
+		const std::scoped_lock lock(mMutex);
+		if (version == mVersion)
+			return;
+
+		mEntries.clear();
+		mIndex.clear();
+		mVersion = version;
+	}
+
+	void ResultCache::Clear()
+	{
+		const std::scoped_lock lock(mMutex);
+		mEntries.clear();
+		mIndex.clear();
+	}
+
+	ResultCacheStats ResultCache::GetStats() const
+	{
+		const std::scoped_lock lock(mMutex);
+
+		ResultCacheStats stats;
+		stats.mHits = mHits;
+		stats.mMisses = mMisses;
+		stats.mEvictions = mEvictions;
+		stats.mSize = mEntries.size();
+		stats.mCapacity = mCapacity;
+		return stats;
+	}
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "CppFlowLib.h"
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TF
+{
+	/// <summary>
+	/// Struct representing the counters of a ResultCache.
+	/// </summary>
+	struct ResultCacheStats
+	{
+	public:
+		uint64_t mHits = 0;
+		uint64_t mMisses = 0;
+		uint64_t mEvictions = 0;
+
+		size_t mSize = 0;
+		size_t mCapacity = 0;
+	};
+
+	/// <summary>
+	/// Class representing a bounded, least recently used cache of model outputs keyed by a hash
+	/// of the inputs. Entries keep a copy of the inputs they were computed from, compared on
+	/// every hit, so colliding hashes never return the outputs of other inputs. Entries are bound
+	/// to the model version they were computed with, and the cache empties itself when used with
+	/// a different version.
+	///
+	/// Cached output tensors are shared with every caller hitting the entry and must not be modified.
+	/// </summary>
+	class ResultCache
+	{
+	public:
+		using Outputs = std::unordered_map<std::string, cppflow::tensor>;
+
+		/// <summary>
+		/// Struct representing the key of a run: the bytes of its inputs and requested outputs, and their hash.
+		/// </summary>
+		struct Key
+		{
+		public:
+			uint64_t mHash = 0;
+			std::string mBytes;
+		};
+	public:
+		/// <summary>
+		/// Constructor initializing a ResultCache.
+		/// </summary>
+		/// <param name="capacity">The maximum number of cached results</param>
+		/// <param name="version">The current model version</param>
+		ResultCache(size_t capacity,
+					uint32_t version = 0);
+
+		/// <summary>
+		/// Computes the cache key of a run from the contents of its inputs and the requested outputs.
+		/// String tensors are not supported as their buffers hold pointers rather than the data.
+		/// </summary>
+		/// <param name="input_tensors">The input tensors</param>
+		/// <param name="output_names">The requested output names</param>
+		/// <param name="version">The model version</param>
+		/// <param name="key">The computed key</param>
+		/// <returns>True if the inputs can be cached</returns>
+		static bool ComputeKey(const std::unordered_map<std::string, cppflow::tensor>& input_tensors,
+							   const std::vector<std::string>& output_names,
+							   uint32_t version,
+							   Key& key);
+
+		/// <summary>
+		/// Looks up a cached result, marking it as the most recently used on a hit. Lookups of
+		/// another version than the current one are misses and leave the cache untouched.
+		/// </summary>
+		/// <param name="key">The cache key</param>
+		/// <param name="version">The model version</param>
+		/// <param name="output">The cached outputs, merged into the given map</param>
+		/// <returns>True if the result was cached</returns>
+		bool Find(const Key& key,
+				  uint32_t version,
+				  Outputs& output);
+
+		/// <summary>
+		/// Stores a result, evicting the least recently used one when full. Results of another
+		/// version than the current one are not stored.
+		/// </summary>
+		/// <param name="key">The cache key</param>
+		/// <param name="version">The model version</param>
+		/// <param name="output">The outputs to cache</param>
+		void Insert(const Key& key,
+					uint32_t version,
+					const Outputs& output);
+
+		/// <summary>
+		/// Sets the current model version, removing the cached results of the previous one.
+		/// Called when a version is published, so lookups of runs still using a replaced
+		/// version cannot flush the results of the current one.
+		/// </summary>
+		/// <param name="version">The published model version</param>
+		void SetVersion(uint32_t version);
+
+		/// <summary>
+		/// Removes all cached results.
+		/// </summary>
+		void Clear();
+
+		/// <summary>
+		/// Retrieves the cache counters.
+		/// </summary>
+		/// <returns>The counters</returns>
+		ResultCacheStats GetStats() const;
+	private:
+		struct Entry
+		{
+			Key mKey;
+			Outputs mOutput;
+		};
+
+		size_t mCapacity = 0;
+		uint32_t mVersion = 0;
+
+		// Most recently used first
+		std::list<Entry> mEntries;
+		std::unordered_map<uint64_t, std::list<Entry>::iterator> mIndex;
+
+		uint64_t mHits = 0;
+		uint64_t mMisses = 0;
+		uint64_t mEvictions = 0;
+
+		mutable std::mutex mMutex = {};
+	};
+}
@@ -0,0 +1,132 @@
+#include "Models/MLTrainingStore.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+namespace TF
+{
+	TrainingStore::TrainingStore(size_t shard_count)
+	{
+		if (shard_count == 0)
+			shard_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+		mShards.reserve(shard_count);
+		for (size_t i = 0; i < shard_count; ++i)
+			mShards.push_back(std::make_unique<Shard>());
+	}
+
+	std::shared_ptr<const TrainingBatch> TrainingStore::Snapshot() const
+	{
+		const std::scoped_lock snapshot_lock(mSnapshotMutex);
+
+		// Only moves the pending batches out under the shard locks, the merge runs without them
+		std::vector<TrainingBatch> pending;
+		for (const std::unique_ptr<Shard>& shard : mShards)
+		{
+			const std::scoped_lock lock(shard->mMutex);
+			if (!shard->mBatch.mInputs.empty() || !shard->mBatch.mLabels.empty())
+				pending.push_back(std::exchange(shard->mBatch, TrainingBatch()));
+		}
+
+		if (pending.empty())
+		{
+			if (std::shared_ptr<const TrainingBatch> snapshot = mpSnapshot.lock())
+				return snapshot;
+		}
+
+		// Merged in place once every user of the last snapshot released it, into a copy otherwise
+		if (!mpMerged)
+			mpMerged = std::make_shared<TrainingBatch>();
+		else if (mpSnapshotReleased && !mpSnapshotReleased->load(std::memory_order_acquire))
+			mpMerged = std::make_shared<TrainingBatch>(*mpMerged);
+
+		for (TrainingBatch& batch : pending)
+		{
+			const uint64_t sample_count = batch.GetSampleCount();
+			if (!mpMerged->Append(std::move(batch)))
+				std::cerr << "Dropped " << sample_count << " training samples that could not be merged into the snapshot." << std::endl;
+		}
+
+		// The release flag is set after the last reader of the snapshot is done with it
+		std::shared_ptr<std::atomic<bool>> released = std::make_shared<std::atomic<bool>>(false);
+		std::shared_ptr<const TrainingBatch> snapshot(mpMerged.get(), [merged = mpMerged, released](const TrainingBatch*)
+		{
+			released->store(true, std::memory_order_release);
+		});
+
+		mpSnapshot = snapshot;
+		mpSnapshotReleased = std::move(released);
+		return snapshot;
+	}
+
+	TrainingStore::Shard& TrainingStore::GetShard()
+	{
+		const size_t index = std::hash<std::thread::id>()(std::this_thread::get_id()) % mShards.size();
+		return *mShards[index];
+	}
+
+	TrainingStore::ColumnCounts TrainingStore::GetCounts(const TrainingBatch& batch)
+	{
+		ColumnCounts counts;
+		for (const TrainingColumn& input : batch.mInputs)
+			counts.mInputs.push_back(input.mCount);
+		for (const TrainingColumn& label : batch.mLabels)
+			counts.mLabels.push_back(label.mCount);
+		return counts;
+	}
+
+	void TrainingStore::Restore(TrainingBatch& batch,
+								const ColumnCounts& counts)
+	{
+		batch.mInputs.erase(batch.mInputs.begin() + counts.mInputs.size(), batch.mInputs.end());
+		batch.mLabels.erase(batch.mLabels.begin() + counts.mLabels.size(), batch.mLabels.end());
+		for (size_t i = 0; i < counts.mInputs.size(); ++i)
+			batch.mInputs[i].Truncate(counts.mInputs[i]);
+		for (size_t i = 0; i < counts.mLabels.size(); ++i)
+			batch.mLabels[i].Truncate(counts.mLabels[i]);
+	}
+
+	bool TrainingStore::CheckSchema(const TrainingBatch& batch,
+									const ColumnCounts& counts)
+	{
+		const std::scoped_lock lock(mSchemaMutex);
+
+		// Checks every grown column before recording any, so a mismatch records nothing
+		std::vector<std::pair<std::unordered_map<std::string, ColumnSchema>*, const TrainingColumn*>> unknown;
+		auto check = [&](std::unordered_map<std::string, ColumnSchema>& schemas,
+						 const std::vector<TrainingColumn>& columns,
+						 const std::vector<uint64_t>& previous)
+		{
+			for (size_t i = 0; i < columns.size(); ++i)
+			{
+				const TrainingColumn& column = columns[i];
+				if (column.mCount == 0 || (i < previous.size() && column.mCount == previous[i]))
+					continue;
+
+				auto found = schemas.find(column.mName);
+				if (found == schemas.end())
+				{
+					unknown.emplace_back(&schemas, &column);
+					continue;
+				}
+
+				const ColumnSchema& schema = found->second;
+				if (schema.mType != column.mType || schema.mDomain != column.mDomain)
+					return false;
+				if (!column.IsImage() && schema.mShape != column.mShape)
+					return false;
+			}
+			return true;
+		};
+
+		if (!check(mInputSchema, batch.mInputs, counts.mInputs) || !check(mLabelSchema, batch.mLabels, counts.mLabels))
+			return false;
+
+		for (const auto& [schemas, column] : unknown)
+			schemas->emplace(column->mName, ColumnSchema{ column->mType, column->mDomain, column->mShape });
+		return true;
+	}
+}
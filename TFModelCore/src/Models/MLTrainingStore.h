@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Core/TFTrainingBatch.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TF
+{
+	/// <summary>
+	/// Class representing the training data of a model, added concurrently by any number of threads.
+	///
+	/// Samples are appended to shards picked by the calling thread, each behind its own lock, so
+	/// producers on different threads rarely contend. Every column keeps the type and shape of its
+	/// first samples across all shards, so the shards can always be merged. Snapshot only holds a
+	/// shard lock while moving its pending samples out, and merges them outside of any shard lock,
+	/// so producers keep adding samples while a snapshot is taken.
+	/// </summary>
+	class TrainingStore
+	{
+	public:
+		/// <summary>
+		/// Constructor initializing a TrainingStore.
+		/// </summary>
+		/// <param name="shard_count">The number of shards, 0 for one per hardware thread</param>
+		TrainingStore(size_t shard_count = 0);
+
+		/// <summary>
+		/// Appends samples to the shard of the calling thread. The add function is called with the
+		/// shard lock held and must leave the batch unchanged when it fails. Samples whose type or
+		/// shape differs from the samples added to another shard are removed again.
+		/// </summary>
+		/// <param name="add">Function appending the samples to a batch, returning true on success</param>
+		/// <returns>True if the samples were added</returns>
+		template<typename AddFunction>
+		bool Add(AddFunction&& add);
+
+		/// <summary>
+		/// Retrieves every sample added so far as one batch. Each call of Add is either fully part
+		/// of the snapshot or not at all, and samples of a thread keep the order they were added in.
+		/// </summary>
+		/// <returns>The snapshot, which is never modified afterwards</returns>
+		std::shared_ptr<const TrainingBatch> Snapshot() const;
+
+		size_t GetShardCount() const { return mShards.size(); }
+	private:
+		struct Shard
+		{
+			std::mutex mMutex = {};
+
+			// Samples added since the last snapshot
+			TrainingBatch mBatch;
+		};
+
+		struct ColumnSchema
+		{
+			DataType mType = DataType::Float32;
+			DomainType mDomain = DomainType::Data;
+			std::vector<int64_t> mShape;
+		};
+
+		// Sample count of each input and label column of a batch
+		struct ColumnCounts
+		{
+			std::vector<uint64_t> mInputs;
+			std::vector<uint64_t> mLabels;
+		};
+
+		/// <summary>
+		/// Retrieves the shard of the calling thread.
+		/// </summary>
+		/// <returns>The shard</returns>
+		Shard& GetShard();
+
+		/// <summary>
+		/// Retrieves the sample count of each column of a batch.
+		/// </summary>
+		/// <param name="batch">The batch</param>
+		/// <returns>The sample counts</returns>
+		static ColumnCounts GetCounts(const TrainingBatch& batch);
+
+		/// <summary>
+		/// Removes the columns and samples added to a batch since its counts were retrieved.
+		/// </summary>
+		/// <param name="batch">The batch</param>
+		/// <param name="counts">The previous sample counts</param>
+		static void Restore(TrainingBatch& batch,
+							const ColumnCounts& counts);
+
+		/// <summary>
+		/// Checks the columns of a batch that grew since its counts were retrieved against the
+		/// schema shared by the shards, recording the columns seen for the first time.
+		/// </summary>
+		/// <param name="batch">The batch</param>
+		/// <param name="counts">The previous sample counts</param>
+		/// <returns>True if every column matches the schema, nothing is recorded otherwise</returns>
+		bool CheckSchema(const TrainingBatch& batch,
+						 const ColumnCounts& counts);
+	private:
+		std::vector<std::unique_ptr<Shard>> mShards;
+
+		// Type and shape of every column added to any shard, locked after a shard lock
+		std::unordered_map<std::string, ColumnSchema> mInputSchema;
+		std::unordered_map<std::string, ColumnSchema> mLabelSchema;
+		std::mutex mSchemaMutex = {};
+
+		// Samples merged so far, only appended to in place once no snapshot of them is in use
+		mutable std::shared_ptr<TrainingBatch> mpMerged = nullptr;
+
+		// Last snapshot handed out, and whether all of its users released it
+		mutable std::weak_ptr<const TrainingBatch> mpSnapshot;
+		mutable std::shared_ptr<std::atomic<bool>> mpSnapshotReleased = nullptr;
+		mutable std::mutex mSnapshotMutex = {};
+	};
+
+	template<typename AddFunction>
+	bool TrainingStore::Add(AddFunction&& add)
+	{
+		Shard& shard = GetShard();
+
+		const std::scoped_lock lock(shard.mMutex);
+		const ColumnCounts counts = GetCounts(shard.mBatch);
+		if (!add(shard.mBatch))
+			return false;
+
+		if (CheckSchema(shard.mBatch, counts))
+			return true;
+
+		Restore(shard.mBatch, counts);
+		std::cerr << "Training data does not match the type or shape of the samples already added." << std::endl;
+		return false;
+	}
+}
@@ -6,7 +6,18 @@
 #include "Core/TFModelLayout.h"
 #include "Core/TFTrainingBatch.h"
 #include "Core/TFTrainingConfig.h"
+#include "Core/TFSessionConfig.h"
+#include "Core/TFSignatureDef.h"
+#include "Core/TFSession.h"
+#include "Core/TFGraphBuilder.h"
+#include "Core/TFTrainer.h"
+#include "Core/TFTensorUtils.h"
+#include "Core/TFTensorView.h"
+#include "Core/TFTensorPool.h"
 
 #include "Data/TFImageLoader.h"
 
-#include "Models/MLModel.h"
\ No newline at end of file
+#include "Models/MLResultCache.h"
+#include "Models/MLConversionCache.h"
+#include "Models/MLModel.h"
+#include "Models/MLBatchScheduler.h"
\ No newline at end of file
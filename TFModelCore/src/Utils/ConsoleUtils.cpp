@@ -5,6 +5,7 @@
 #include <memory>
 #include <string>
 #include <array>
+#include <cstdlib>
 
 bool ConsoleUtils::Execute(const char* cmd,
 							std::string* output)
@@ -28,4 +29,58 @@ bool ConsoleUtils::Execute(const char* cmd,
 	}
 
 	return true;
-}
\ No newline at end of file
+}
+
+bool ConsoleUtils::ExecuteStreaming(const char* cmd,
+									const std::function<void(const std::string&)>& on_line)
+{
+	std::unique_ptr<FILE, decltype(&_pclose)> pipe(_popen(cmd, "r"), _pclose);
+	if (!pipe)
+	{
+		std::cerr << "popen() failed!" << std::endl;
+		return false;
+	}
+
+	// Lines longer than the buffer are read in several parts
+	std::array<char, 128> buffer;
+	std::string line;
+	while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr)
+	{
+		line += buffer.data();
+		if (line.empty() || line.back() != '\n')
+			continue;
+
+		line.pop_back();
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		on_line(line);
+		line.clear();
+	}
+
+	if (!line.empty())
+		on_line(line);
+
+	// Released to read the exit status, which the deleter would discard
+	const int status = _pclose(pipe.release());
+	if (status != 0)
+	{
+		std::cerr << "Command exited with status " << status << ": " << cmd << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void ConsoleUtils::SetEnvironment(const char* name,
+								  const char* value,
+								  bool overwrite)
+{
+	if (!overwrite && std::getenv(name) != nullptr)
+		return;
+
+#ifdef _WIN32
+	_putenv_s(name, value);
+#else
+	setenv(name, value, 1);
+#endif
+}
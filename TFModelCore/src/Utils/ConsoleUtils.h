@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <string>
 
 struct ConsoleUtils
@@ -12,4 +13,24 @@ struct ConsoleUtils
 	/// <returns>True if the execution is successful</returns>
 	static bool Execute(const char* cmd, 
 						std::string* output = nullptr);
+
+	/// <summary>
+	/// Executes a console command, passing each line of its output to a callback as soon as
+	/// it is written.
+	/// </summary>
+	/// <param name="cmd">The console command to execute</param>
+	/// <param name="on_line">The callback receiving each output line, without its line break</param>
+	/// <returns>True if the command ran and exited with a zero status</returns>
+	static bool ExecuteStreaming(const char* cmd,
+								 const std::function<void(const std::string&)>& on_line);
+
+	/// <summary>
+	/// Sets an environment variable of the current process.
+	/// </summary>
+	/// <param name="name">The variable name</param>
+	/// <param name="value">The variable value</param>
+	/// <param name="overwrite">Whether to replace an already set value</param>
+	static void SetEnvironment(const char* name,
+							   const char* value,
+							   bool overwrite = true);
 };
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "Utils/HashUtils.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+static uint64_t MixHash(uint64_t value)
+{
+	value ^= value >> 33;
+	value *= 0xFF51AFD7ED558CCDULL;
+	value ^= value >> 33;
+	value *= 0xC4CEB9FE1A85EC53ULL;
+	value ^= value >> 33;
+	return value;
+}
+
+uint64_t HashUtils::HashBytes(const void* data,
+							  size_t length,
+							  uint64_t seed)
+{
+	static constexpr uint64_t Multiplier = 0x9E3779B97F4A7C15ULL;
+
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash = seed ^ (length * Multiplier);
+
+	// Consume whole words, then fold in the remaining tail bytes
+	size_t offset = 0;
+	for (; offset + sizeof(uint64_t) <= length; offset += sizeof(uint64_t))
+	{
+		uint64_t word;
+		std::memcpy(&word, bytes + offset, sizeof(uint64_t));
+		hash = (hash ^ MixHash(word)) * Multiplier;
+	}
+
+	uint64_t tail = 0;
+	for (size_t i = 0; offset + i < length; ++i)
+		tail |= static_cast<uint64_t>(bytes[offset + i]) << (8 * i);
+
+	return MixHash(hash ^ MixHash(tail));
+}
+
+bool HashUtils::HashFile(const std::filesystem::path& path,
+						 uint64_t& hash)
+{
+	std::ifstream in(path, std::ios::binary);
+	if (!in.is_open())
+		return false;
+
+	std::vector<char> buffer(1 << 20);
+	while (in)
+	{
+		in.read(buffer.data(), buffer.size());
+		const std::streamsize count = in.gcount();
+		if (count > 0)
+			hash = HashBytes(buffer.data(), static_cast<size_t>(count), hash);
+	}
+	return !in.bad();
+}
+
+std::string HashUtils::ToHex(uint64_t hash)
+{
+	std::stringstream ss;
+	ss << std::hex << std::setfill('0') << std::setw(16) << hash;
+	return ss.str();
+}
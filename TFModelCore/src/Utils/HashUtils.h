@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+struct HashUtils
+{
+	/// <summary>
+	/// Computes a fast, non-cryptographic 64-bit hash of a byte range.
+	/// </summary>
+	/// <param name="data">The bytes to hash</param>
+	/// <param name="length">The number of bytes</param>
+	/// <param name="seed">The seed to combine the hash with</param>
+	/// <returns>The hash value</returns>
+	static uint64_t HashBytes(const void* data,
+							  size_t length,
+							  uint64_t seed = 0);
+
+	/// <summary>
+	/// Computes the hash of a file's contents, reading it in chunks.
+	/// </summary>
+	/// <param name="path">The file path</param>
+	/// <param name="hash">The seed to combine the hash with, replaced by the hash value</param>
+	/// <returns>True if the file could be read</returns>
+	static bool HashFile(const std::filesystem::path& path,
+						 uint64_t& hash);
+
+	/// <summary>
+	/// Formats a hash value as a fixed width hexadecimal string.
+	/// </summary>
+	/// <param name="hash">The hash value</param>
+	/// <returns>The hexadecimal string</returns>
+	static std::string ToHex(uint64_t hash);
+};
@@ -0,0 +1,330 @@
+#include "Utils/PythonWorker.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+/// <summary>
+/// Creates a pipe whose ends are closed on exec, so that processes started later by any thread
+/// do not keep them open. The child of the worker duplicates the ends it uses onto its standard
+/// streams, which are inherited.
+/// </summary>
+/// <param name="fds">The read and write ends</param>
+/// <returns>True if the pipe was created</returns>
+static bool CreateWorkerPipe(int fds[2])
+{
+#ifdef __APPLE__
+	// No pipe2, a fork between the two calls may still inherit the pipe
+	if (pipe(fds) != 0)
+		return false;
+
+	fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+	fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+	return true;
+#else
+	return pipe2(fds, O_CLOEXEC) == 0;
+#endif
+}
+#endif
+
+PythonWorker::PythonWorker(const std::string& script_directory,
+						   const std::string& python)
+{
+	const std::string script = script_directory + "/tf_worker.py";
+
+#ifdef _WIN32
+	SECURITY_ATTRIBUTES attributes = {};
+	attributes.nLength = sizeof(SECURITY_ATTRIBUTES);
+	attributes.bInheritHandle = TRUE;
+
+	HANDLE input_read = nullptr;
+	HANDLE input_write = nullptr;
+	HANDLE output_read = nullptr;
+	HANDLE output_write = nullptr;
+	if (!CreatePipe(&input_read, &input_write, &attributes, 0))
+		throw std::runtime_error("Failed to create Python Worker input pipe.");
+
+	if (!CreatePipe(&output_read, &output_write, &attributes, 0))
+	{
+		CloseHandle(input_read);
+		CloseHandle(input_write);
+		throw std::runtime_error("Failed to create Python Worker output pipe.");
+	}
+
+	// Only the child's ends of the pipes are inherited
+	SetHandleInformation(input_write, HANDLE_FLAG_INHERIT, 0);
+	SetHandleInformation(output_read, HANDLE_FLAG_INHERIT, 0);
+
+	STARTUPINFOA startup = {};
+	startup.cb = sizeof(STARTUPINFOA);
+	startup.dwFlags = STARTF_USESTDHANDLES;
+	startup.hStdInput = input_read;
+	startup.hStdOutput = output_write;
+	startup.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+	std::string cmd = "\"" + python + "\" -u \"" + script + "\"";
+	std::vector<char> cmd_buffer(cmd.begin(), cmd.end());
+	cmd_buffer.push_back('\0');
+
+	PROCESS_INFORMATION process = {};
+	const BOOL created = CreateProcessA(nullptr, cmd_buffer.data(), nullptr, nullptr, TRUE, 0, nullptr, nullptr, &startup, &process);
+
+	CloseHandle(input_read);
+	CloseHandle(output_write);
+
+	if (!created)
+	{
+		CloseHandle(input_write);
+		CloseHandle(output_read);
+		throw std::runtime_error("Failed to start Python Worker {" + cmd + "}");
+	}
+
+	CloseHandle(process.hThread);
+	mProcess = process.hProcess;
+	mInputWrite = input_write;
+	mOutputRead = output_read;
+#else
+	int input_pipe[2];
+	int output_pipe[2];
+	if (!CreateWorkerPipe(input_pipe))
+		throw std::runtime_error("Failed to create Python Worker input pipe.");
+
+	if (!CreateWorkerPipe(output_pipe))
+	{
+		close(input_pipe[0]);
+		close(input_pipe[1]);
+		throw std::runtime_error("Failed to create Python Worker output pipe.");
+	}
+
+	const pid_t pid = fork();
+	if (pid == 0)
+	{
+		dup2(input_pipe[0], STDIN_FILENO);
+		dup2(output_pipe[1], STDOUT_FILENO);
+		close(input_pipe[0]);
+		close(input_pipe[1]);
+		close(output_pipe[0]);
+		close(output_pipe[1]);
+
+		execlp(python.c_str(), python.c_str(), "-u", script.c_str(), static_cast<char*>(nullptr));
+		_exit(127);
+	}
+
+	close(input_pipe[0]);
+	close(output_pipe[1]);
+
+	if (pid < 0)
+	{
+		close(input_pipe[1]);
+		close(output_pipe[0]);
+		throw std::runtime_error("Failed to start Python Worker {" + script + "}");
+	}
+
+	mProcess = pid;
+	mInputWrite = input_pipe[1];
+	mOutputRead = output_pipe[0];
+#endif
+
+	mAlive = true;
+}
+
+PythonWorker::~PythonWorker()
+{
+	const std::scoped_lock lock(mCallMutex);
+	if (mAlive)
+		WriteLine(nlohmann::json({ { "id", 0 }, { "command", "shutdown" } }).dump());
+
+	Close();
+}
+
+bool PythonWorker::Call(const std::string& command,
+						const nlohmann::json& args,
+						nlohmann::json& response,
+						const EventCallback& on_event)
+{
+	const std::scoped_lock lock(mCallMutex);
+	if (!mAlive)
+		return false;
+
+	const uint64_t id = mNextRequestId++;
+
+	nlohmann::json request;
+	request["id"] = id;
+	request["command"] = command;
+	request["args"] = args;
+
+	if (!WriteLine(request.dump()))
+	{
+		std::cerr << "Failed to send command '" << command << "' to Python Worker." << std::endl;
+		mAlive = false;
+		return false;
+	}
+
+	std::string line;
+	while (ReadLine(line))
+	{
+		nlohmann::json message;
+		try
+		{
+			message = nlohmann::json::parse(line);
+		}
+		catch (const std::exception&)
+		{
+			std::cerr << "Invalid Python Worker message: " << line << std::endl;
+			continue;
+		}
+
+		if (!message.contains("id") || message["id"].is_null() || message["id"].get<uint64_t>() != id)
+			continue;
+
+		if (message.contains("status"))
+		{
+			response = std::move(message);
+			return true;
+		}
+
+		if (on_event)
+			on_event(message);
+	}
+
+	std::cerr << "Python Worker exited while running command '" << command << "'." << std::endl;
+	mAlive = false;
+	return false;
+}
+
+bool PythonWorker::IsAlive() const
+{
+	const std::scoped_lock lock(mCallMutex);
+	return mAlive;
+}
+
+bool PythonWorker::WriteLine(const std::string& line)
+{
+	const std::string data = line + "\n";
+
+#ifdef _WIN32
+	size_t written = 0;
+	while (written < data.size())
+	{
+		DWORD count = 0;
+		if (!WriteFile(static_cast<HANDLE>(mInputWrite), data.data() + written, static_cast<DWORD>(data.size() - written), &count, nullptr))
+			return false;
+		written += static_cast<size_t>(count);
+	}
+	return true;
+#else
+	// A worker that died must surface as a failed write rather than terminate the process, without
+	// changing the SIGPIPE disposition of the host: the signal is blocked on this thread while writing
+	sigset_t pipe_signal;
+	sigemptyset(&pipe_signal);
+	sigaddset(&pipe_signal, SIGPIPE);
+
+	sigset_t previous_mask;
+	pthread_sigmask(SIG_BLOCK, &pipe_signal, &previous_mask);
+
+	sigset_t pending;
+	sigpending(&pending);
+	const bool was_pending = sigismember(&pending, SIGPIPE) == 1;
+
+	bool broken_pipe = false;
+	size_t written = 0;
+	while (written < data.size())
+	{
+		const ssize_t count = write(mInputWrite, data.data() + written, data.size() - written);
+		if (count < 0 && errno == EINTR)
+			continue;
+		if (count <= 0)
+		{
+			broken_pipe = count < 0 && errno == EPIPE;
+			break;
+		}
+		written += static_cast<size_t>(count);
+	}
+
+	// Consume the SIGPIPE raised by this write, leaving one the host was already delivered pending
+	if (broken_pipe && !was_pending)
+	{
+		sigpending(&pending);
+		if (sigismember(&pending, SIGPIPE) == 1)
+		{
+			int signal = 0;
+			sigwait(&pipe_signal, &signal);
+		}
+	}
+
+	pthread_sigmask(SIG_SETMASK, &previous_mask, nullptr);
+	return written == data.size();
+#endif
+}
+
+bool PythonWorker::ReadLine(std::string& line)
+{
+	char buffer[4096];
+	while (true)
+	{
+		const size_t pos = mReadBuffer.find('\n');
+		if (pos != std::string::npos)
+		{
+			line = mReadBuffer.substr(0, pos);
+			mReadBuffer.erase(0, pos + 1);
+			return true;
+		}
+
+#ifdef _WIN32
+		DWORD count = 0;
+		if (!ReadFile(static_cast<HANDLE>(mOutputRead), buffer, sizeof(buffer), &count, nullptr) || count == 0)
+			return false;
+#else
+		const ssize_t count = read(mOutputRead, buffer, sizeof(buffer));
+		if (count < 0 && errno == EINTR)
+			continue;
+		if (count <= 0)
+			return false;
+#endif
+		mReadBuffer.append(buffer, static_cast<size_t>(count));
+	}
+}
+
+void PythonWorker::Close()
+{
+	mAlive = false;
+
+#ifdef _WIN32
+	if (mInputWrite)
+		CloseHandle(static_cast<HANDLE>(mInputWrite));
+	if (mOutputRead)
+		CloseHandle(static_cast<HANDLE>(mOutputRead));
+
+	if (mProcess)
+	{
+		WaitForSingleObject(static_cast<HANDLE>(mProcess), INFINITE);
+		CloseHandle(static_cast<HANDLE>(mProcess));
+	}
+
+	mInputWrite = mOutputRead = mProcess = nullptr;
+#else
+	if (mInputWrite >= 0)
+		close(mInputWrite);
+	if (mOutputRead >= 0)
+		close(mOutputRead);
+
+	if (mProcess > 0)
+		waitpid(mProcess, nullptr, 0);
+
+	mInputWrite = mOutputRead = mProcess = -1;
+#endif
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+/// <summary>
+/// Class representing a long-lived Python process running PythonScripts/tf_worker.py.
+/// TensorFlow is imported once by the worker, and commands are exchanged as line-delimited
+/// JSON over the process' standard input/output.
+/// </summary>
+class PythonWorker
+{
+public:
+	using EventCallback = std::function<void(const nlohmann::json&)>;
+public:
+	/// <summary>
+	/// Constructor starting the worker process.
+	/// </summary>
+	/// <param name="script_directory">The directory containing tf_worker.py</param>
+	/// <param name="python">The Python executable</param>
+	PythonWorker(const std::string& script_directory,
+				 const std::string& python = "python");
+
+	/// <summary>
+	/// Destructor asking the worker to exit and waiting for it.
+	/// </summary>
+	~PythonWorker();
+
+	PythonWorker(const PythonWorker&) = delete;
+	PythonWorker& operator=(const PythonWorker&) = delete;
+public:
+	/// <summary>
+	/// Sends a command to the worker and waits for its response. Calls are serialized,
+	/// as the worker handles one command at a time.
+	/// </summary>
+	/// <param name="command">The command name</param>
+	/// <param name="args">The command arguments</param>
+	/// <param name="response">The response, with a "status" of "ok" or "error"</param>
+	/// <param name="on_event">Optional callback receiving the events streamed before the response</param>
+	/// <returns>True if a response was received, false if the worker is no longer running</returns>
+	bool Call(const std::string& command,
+			  const nlohmann::json& args,
+			  nlohmann::json& response,
+			  const EventCallback& on_event = nullptr);
+
+	/// <summary>
+	/// Checks whether the worker process is still usable.
+	/// </summary>
+	/// <returns>True if the worker is running</returns>
+	bool IsAlive() const;
+private:
+	/// <summary>
+	/// Writes a line to the worker's standard input.
+	/// </summary>
+	/// <param name="line">The line, without its terminator</param>
+	/// <returns>True if the line was written</returns>
+	bool WriteLine(const std::string& line);
+
+	/// <summary>
+	/// Reads a line from the worker's standard output.
+	/// </summary>
+	/// <param name="line">The line, without its terminator</param>
+	/// <returns>True if a line was read, false on end of stream</returns>
+	bool ReadLine(std::string& line);
+
+	/// <summary>
+	/// Closes the pipes and waits for the worker process to exit.
+	/// </summary>
+	void Close();
+private:
+#ifdef _WIN32
+	void* mProcess = nullptr;
+	void* mInputWrite = nullptr;
+	void* mOutputRead = nullptr;
+#else
+	int mProcess = -1;
+	int mInputWrite = -1;
+	int mOutputRead = -1;
+#endif
+
+	// Bytes read past the end of the last returned line
+	std::string mReadBuffer;
+
+	uint64_t mNextRequestId = 1;
+	bool mAlive = false;
+
+	mutable std::mutex mCallMutex = {};
+};
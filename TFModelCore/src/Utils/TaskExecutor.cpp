@@ -0,0 +1,103 @@
+#include "Utils/TaskExecutor.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+TaskExecutor::TaskExecutor(uint32_t worker_count,
+						   uint32_t max_queue_depth)
+	: mMaxQueueDepth(max_queue_depth)
+{
+	if (mMaxQueueDepth == 0)
+		throw std::invalid_argument("Max Queue Depth must be greater than zero.");
+
+	if (worker_count == 0)
+		worker_count = std::max(1u, std::thread::hardware_concurrency());
+
+	mWorkers.reserve(worker_count);
+	for (uint32_t i = 0; i < worker_count; ++i)
+		mWorkers.emplace_back(&TaskExecutor::WorkerLoop, this);
+}
+
+TaskExecutor::~TaskExecutor()
+{
+	{
+		const std::scoped_lock lock(mQueueMutex);
+		mStopping = true;
+	}
+	mTaskAvailable.notify_all();
+	mSpaceAvailable.notify_all();
+
+	for (std::thread& worker : mWorkers)
+	{
+		if (worker.joinable())
+			worker.join();
+	}
+}
+
+bool TaskExecutor::Submit(std::function<void()> task,
+						  uint32_t* queue_depth)
+{
+	{
+		std::unique_lock lock(mQueueMutex);
+		mSpaceAvailable.wait(lock, [&]() { return mStopping || mQueue.size() < mMaxQueueDepth; });
+		if (mStopping)
+			return false;
+
+		mQueue.push_back(std::move(task));
+		if (queue_depth)
+			*queue_depth = static_cast<uint32_t>(mQueue.size());
+	}
+	mTaskAvailable.notify_one();
+	return true;
+}
+
+bool TaskExecutor::TrySubmit(std::function<void()> task,
+							 uint32_t* queue_depth)
+{
+	{
+		const std::scoped_lock lock(mQueueMutex);
+		if (mStopping || mQueue.size() >= mMaxQueueDepth)
+			return false;
+
+		mQueue.push_back(std::move(task));
+		if (queue_depth)
+			*queue_depth = static_cast<uint32_t>(mQueue.size());
+	}
+	mTaskAvailable.notify_one();
+	return true;
+}
+
+void TaskExecutor::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock lock(mQueueMutex);
+			mTaskAvailable.wait(lock, [&]() { return mStopping || !mQueue.empty(); });
+
+			// Remaining tasks are drained before stopping
+			if (mQueue.empty())
+				return;
+
+			task = std::move(mQueue.front());
+			mQueue.pop_front();
+		}
+		mSpaceAvailable.notify_one();
+
+		// A failing task must not take the worker, and the process, down with it
+		try
+		{
+			task();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "Executor task failed: " << e.what() << std::endl;
+		}
+		catch (...)
+		{
+			std::cerr << "Executor task failed with an unknown exception." << std::endl;
+		}
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Class representing a fixed pool of worker threads consuming a bounded task queue.
+/// </summary>
+class TaskExecutor
+{
+public:
+	/// <summary>
+	/// Constructor initializing a TaskExecutor and starting its workers.
+	/// </summary>
+	/// <param name="worker_count">The number of worker threads, hardware concurrency if zero</param>
+	/// <param name="max_queue_depth">The maximum number of queued tasks</param>
+	TaskExecutor(uint32_t worker_count,
+				 uint32_t max_queue_depth);
+
+	/// <summary>
+	/// Destructor running the remaining queued tasks and joining the workers.
+	/// </summary>
+	~TaskExecutor();
+
+	TaskExecutor(const TaskExecutor&) = delete;
+	TaskExecutor& operator=(const TaskExecutor&) = delete;
+public:
+	/// <summary>
+	/// Queues a task, blocking while the queue is full.
+	/// </summary>
+	/// <param name="task">The task to run</param>
+	/// <param name="queue_depth">The queue depth at submission or nullptr if not needed</param>
+	/// <returns>True if the task was queued, false if the executor is stopping</returns>
+	bool Submit(std::function<void()> task,
+				uint32_t* queue_depth = nullptr);
+
+	/// <summary>
+	/// Queues a task without blocking.
+	/// </summary>
+	/// <param name="task">The task to run</param>
+	/// <param name="queue_depth">The queue depth at submission or nullptr if not needed</param>
+	/// <returns>True if the task was queued, false if the queue is full or the executor is stopping</returns>
+	bool TrySubmit(std::function<void()> task,
+				   uint32_t* queue_depth = nullptr);
+private:
+	/// <summary>
+	/// Worker loop running queued tasks until stopped. Exceptions thrown by a task are reported and dropped.
+	/// </summary>
+	void WorkerLoop();
+private:
+	uint32_t mMaxQueueDepth = 0;
+
+	std::deque<std::function<void()>> mQueue;
+	std::mutex mQueueMutex = {};
+	std::condition_variable mTaskAvailable;
+	std::condition_variable mSpaceAvailable;
+	bool mStopping = false;
+
+	std::vector<std::thread> mWorkers;
+};